@@ -24,6 +24,9 @@
 #else
 #include <clocale>
 #endif
+#include "../03-ReverseTools/MultiPatternScan.h"
+#include "../04-CheatEngine/ValueScan.h"
+#include "../02-UEObjectSystem/Reflection.h"
 
 using namespace std;
 
@@ -74,7 +77,25 @@ namespace PatternScanner {
         return tokens;
     }
 
-    vector<size_t> Scan(const unsigned char* data, size_t length, const vector<Token>& pattern) {
+    // Token 数组 -> CompiledPattern（定长数组，不分配内存）
+    PatternEngine::CompiledPattern ToCompiled(const vector<Token>& pattern) {
+        PatternEngine::CompiledPattern compiled;
+        for (const auto& token : pattern) {
+            compiled.Append(token.value, token.wildcard);
+        }
+        compiled.Finalize();
+        return compiled;
+    }
+
+    vector<size_t> Scan(const unsigned char* data, size_t length, const PatternEngine::CompiledPattern& pattern) {
+        if (pattern.Empty() || length < pattern.Size()) {
+            return {};
+        }
+        return PatternEngine::FindAll(data, length, pattern);
+    }
+
+    // 逐字节比较：超过 CompiledPattern::MaxLength 的长特征码走这里
+    vector<size_t> ScanBytes(const unsigned char* data, size_t length, const vector<Token>& pattern) {
         vector<size_t> hits;
         if (pattern.empty() || length < pattern.size()) {
             return hits;
@@ -94,6 +115,30 @@ namespace PatternScanner {
         }
         return hits;
     }
+
+    vector<size_t> Scan(const unsigned char* data, size_t length, const vector<Token>& pattern) {
+        PatternEngine::CompiledPattern compiled = ToCompiled(pattern);
+        if (compiled.overflow) {
+            return ScanBytes(data, length, pattern);
+        }
+        return Scan(data, length, compiled);
+    }
+
+    // 多个特征码一次扫描：result[k] 是第 k 个特征码的全部命中偏移
+    vector<vector<size_t>> ScanBatch(const unsigned char* data, size_t length, const vector<vector<Token>>& patterns) {
+        PatternEngine::MultiPatternScanner scanner;
+        for (const auto& pattern : patterns) {
+            scanner.Add(ToCompiled(pattern));
+        }
+        scanner.Build();
+        vector<vector<size_t>> results = scanner.FindAll(data, length);
+        for (size_t k = 0; k < patterns.size(); k++) {
+            if (scanner.GetPattern(k).overflow) {
+                results[k] = ScanBytes(data, length, patterns[k]);  // 长特征码不进自动机，单独扫
+            }
+        }
+        return results;
+    }
 }
 
 // ====================================
@@ -209,15 +254,20 @@ namespace MemorySearch {
         cout << "搜索范围: 0x" << hex << startAddr << " - 0x" << endAddr << dec << endl;
         cout << "\n找到的地址：" << endl;
         
-        for (uintptr_t addr = startAddr; addr < endAddr; addr += sizeof(int)) {
-            int* ptr = (int*)addr;
-            if (*ptr == searchValue) {
-                size_t offset = addr - startAddr;
-                cout << "  0x" << hex << addr << dec 
-                     << " (偏移: 0x" << hex << offset << dec << ")" 
-                     << " = " << *ptr << endl;
-            }
-        }
+        // 不再逐个 int 比较：SIMD 一次比较多个值，结果写成命中位图
+        auto hits = ValueScan::FirstScan((const uint8_t*)testData, sizeof(testData),
+                                         ValueScan::Condition<int32_t>::Exact(searchValue));
+        hits.ForEach([&](size_t offset) {
+            uintptr_t addr = startAddr + offset;
+            cout << "  0x" << hex << addr << dec 
+                 << " (偏移: 0x" << hex << offset << dec << ")" 
+                 << " = " << *(int*)addr << endl;
+        });
+        
+        // CE 的"介于两值之间"
+        auto range = ValueScan::FirstScan((const uint8_t*)testData, sizeof(testData),
+                                          ValueScan::Condition<int32_t>::Between(200, 300));
+        cout << "介于 200 ~ 300 的值: " << range.Count() << " 个" << endl;
     }
 
     // 演示5：特征码扫描（Pattern Scan）
@@ -232,8 +282,9 @@ namespace MemorySearch {
             0x90, 0x90, 0x90                           // nop nop nop
         };
         
-        const string patternStr = "48 8B 05 ?? ?? ?? ?? 48 85 C0 74 ?? 90 90 90";
-        auto pattern = PatternScanner::ParsePattern(patternStr);
+        // 特征码字面量在编译期就解析成 value/mask
+        constexpr const char* patternStr = "48 8B 05 ?? ?? ?? ?? 48 85 C0 74 ?? 90 90 90";
+        constexpr PatternEngine::CompiledPattern pattern = PatternEngine::Compile(patternStr);
         
         cout << "内存内容: ";
         for (size_t i = 0; i < sizeof(memory); i++) {
@@ -251,6 +302,22 @@ namespace MemorySearch {
                 cout << "找到特征码位置: 0x" << hex << offset << dec << endl;
             }
         }
+
+        // 多个特征码一起扫：只遍历一遍内存
+        const vector<string> batch = {"48 85 C0", "74 ??", "90 90"};
+        vector<vector<PatternScanner::Token>> batchPatterns;
+        for (const auto& str : batch) {
+            batchPatterns.push_back(PatternScanner::ParsePattern(str));
+        }
+        auto batchHits = PatternScanner::ScanBatch(memory, sizeof(memory), batchPatterns);
+        cout << "\n批量扫描（单次遍历）：" << endl;
+        for (size_t k = 0; k < batch.size(); k++) {
+            cout << "  " << batch[k] << " -> " << batchHits[k].size() << " 处";
+            for (size_t offset : batchHits[k]) {
+                cout << " 0x" << hex << offset << dec;
+            }
+            cout << endl;
+        }
     }
 }
 
@@ -312,6 +379,7 @@ int main() {
     
     // 第三部分：UE概念
     UEConcepts::Demo_UEStructures();
+    UEExample::Demo_PropertyLookup();
     
     cout << "\n========================================" << endl;
     cout << "第一课完成！" << endl;
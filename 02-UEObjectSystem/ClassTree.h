@@ -0,0 +1,115 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第二课补充：类继承树缓存
+ * ========================================
+ *
+ * 遍历整个对象表时常要按类过滤（"所有 APawn 的子类"），
+ * 每个对象都沿 SuperStruct 往上走，一个深层的类要比较十几次。
+ *
+ * 这里给每个 UClass 生成一条按深度索引的父类链（UE5 的 FStructBaseChain 做法）：
+ *   AMyCharacter：Chain = [UObject, AActor, APawn, ACharacter, AMyCharacter]，深度 4
+ *   IsChildOf(APawn)：APawn 深度 2 -> 看 Chain[2] 是不是 APawn，两次比较
+ *
+ * 为什么不用前序遍历区间（[进入序号, 离开序号]）：
+ * 区间同样是两次比较，但插入一个新类会让后面所有序号都要重排；
+ * 父类链只依赖自己的祖先，新类登记时只算它自己这一条，已有的类都不用动。
+ * 父类被改（热重载换了 SuperStruct）时只重建这个类的子树。
+ *
+ * 登记/重建在游戏线程做，和 IsA 查询不要并发。
+ */
+
+#pragma once
+#include "UETypes.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class FClassTree {
+public:
+    FClassTree() = default;
+    FClassTree(const FClassTree&) = delete;
+    FClassTree& operator=(const FClassTree&) = delete;
+
+    // 链的内存归树所有：树销毁时把登记过的类恢复成"未登记"，IsChildOf 退回逐层比较
+    ~FClassTree() {
+        for (auto& item : nodes) {
+            item.first->StructBaseChainArray = nullptr;
+            item.first->NumStructBasesInChainMinusOne = -1;
+        }
+    }
+
+    // 登记一个类（父类没登记时先登记父类），返回深度
+    int32_t AddClass(UClass* cls) {
+        auto found = nodes.find(cls);
+        if (found != nodes.end()) return cls->NumStructBasesInChainMinusOne;
+        if (cls->GetSuperClass()) AddClass(cls->GetSuperClass());
+
+        Node& node = nodes[cls];
+        node.parent = cls->GetSuperClass();
+        if (node.parent) nodes[node.parent].children.push_back(cls);
+        BuildChain(cls, node);
+        return cls->NumStructBasesInChainMinusOne;
+    }
+
+    // cls 的 SuperStruct 改了：挂到新父类下，重建它和所有子类的链
+    void Refresh(UClass* cls) {
+        auto found = nodes.find(cls);
+        if (found == nodes.end()) {
+            AddClass(cls);
+            return;
+        }
+        Node& node = found->second;
+        if (node.parent != cls->GetSuperClass()) {
+            if (node.parent) {
+                auto& siblings = nodes[node.parent].children;
+                for (size_t i = 0; i < siblings.size(); i++) {
+                    if (siblings[i] == cls) {
+                        siblings.erase(siblings.begin() + i);
+                        break;
+                    }
+                }
+            }
+            if (cls->GetSuperClass()) AddClass(cls->GetSuperClass());
+            node.parent = cls->GetSuperClass();
+            if (node.parent) nodes[node.parent].children.push_back(cls);
+        }
+
+        std::vector<UClass*> pending{ cls };
+        while (!pending.empty()) {
+            UClass* current = pending.back();
+            pending.pop_back();
+            Node& currentNode = nodes[current];
+            BuildChain(current, currentNode);
+            pending.insert(pending.end(), currentNode.children.begin(), currentNode.children.end());
+        }
+    }
+
+    bool Contains(const UClass* cls) const { return nodes.count(const_cast<UClass*>(cls)) != 0; }
+    size_t Num() const { return nodes.size(); }
+
+    // 直接子类
+    const std::vector<UClass*>& Children(UClass* cls) const {
+        static const std::vector<UClass*> none;
+        auto found = nodes.find(cls);
+        return found != nodes.end() ? found->second.children : none;
+    }
+
+private:
+    struct Node {
+        UClass* parent = nullptr;
+        std::vector<UClass*> children;
+        std::unique_ptr<UClass*[]> chain;       // cls->StructBaseChainArray 指向这里
+    };
+
+    // 父类的链 + 自己（父类的链已经是最新的）
+    void BuildChain(UClass* cls, Node& node) {
+        int32_t depth = node.parent ? node.parent->NumStructBasesInChainMinusOne + 1 : 0;
+        node.chain.reset(new UClass*[depth + 1]);
+        for (int32_t i = 0; i < depth; i++) node.chain[i] = node.parent->StructBaseChainArray[i];
+        node.chain[depth] = cls;
+        cls->StructBaseChainArray = node.chain.get();
+        cls->NumStructBasesInChainMinusOne = depth;
+    }
+
+    std::unordered_map<UClass*, Node> nodes;
+};
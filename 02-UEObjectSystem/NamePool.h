@@ -0,0 +1,191 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第二课补充：FNamePool（GNames）
+ * ========================================
+ *
+ * UE4.23 之后的 GNames 不再是 TArray<FNameEntry*>，而是 FNamePool：
+ *
+ * - 名字字符串连续存放在固定大小的块（Block）里，每块 128KB
+ * - FName::Index（FNameEntryId）= 块号 << 16 | 块内偏移 / 2
+ *   偏移按 2 字节对齐，所以 16 位就能覆盖 128KB 的块
+ * - 每个条目 = 2 字节头 + 字符：
+ *     bit 0       bIsWide（这里只存 ANSI，恒为 0）
+ *     bit 1..5    小写探测哈希（UE 用来加速比较，这里原样保留）
+ *     bit 6..15   长度（最长 1023）
+ * - 0 号条目是 "None"（NAME_None）
+ *
+ * 逆向时从 GNames 解析名字就是按上面的规则算地址：
+ *   entry = Blocks[Index >> 16] + (Index & 0xFFFF) * 2
+ *   len = *(uint16_t*)entry >> 6，字符紧跟在头后面
+ *
+ * 这里的实现：
+ * - 查找/插入用开放寻址哈希表，槽位是一个原子 64 位数（高 32 位哈希标签 | 低 32 位 Id+1），
+ *   插入只用 CAS，不加锁；多个线程同时插入同一个名字时只有一个能占到槽位
+ * - 块内分配也是 CAS 推进游标，新块用 CAS 挂上去
+ * - 解析 Index -> std::string_view 只有两次加载，不分配内存
+ * - 和 UE 一样一旦写入永不删除；块和槽位表的大小在构造时确定
+ * - 比较区分大小写（UE 不区分大小写，第一次出现的写法作为显示名）
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+class FNamePool {
+public:
+    static constexpr uint32_t Stride = 2;                   // 条目按 2 字节对齐
+    static constexpr uint32_t BlockOffsetBits = 16;
+    static constexpr uint32_t BlockBytes = Stride << BlockOffsetBits;   // 128KB
+    static constexpr uint32_t MaxBlocks = 8192;             // 块号 13 位，与 UE 相同
+    static constexpr uint32_t MaxLength = 1023;             // 头里长度只有 10 位
+    static constexpr uint32_t InvalidId = 0xFFFFFFFF;
+
+    // slotBits：哈希表槽位数的位数（默认 2^19 个槽，装载率到 3/4 后拒绝插入）
+    explicit FNamePool(uint32_t slotBits = 19)
+        : slotMask((1u << slotBits) - 1), slots(new std::atomic<uint64_t>[(size_t)1 << slotBits]) {
+        for (uint32_t i = 0; i <= slotMask; i++) slots[i].store(0, std::memory_order_relaxed);
+        for (auto& block : blocks) block.store(nullptr, std::memory_order_relaxed);
+        Store("None");      // NAME_None = 0
+    }
+
+    ~FNamePool() {
+        for (auto& block : blocks) delete[] block.load(std::memory_order_relaxed);
+    }
+
+    FNamePool(const FNamePool&) = delete;
+    FNamePool& operator=(const FNamePool&) = delete;
+
+    // 查找或插入，返回 FNameEntryId；名字过长或表满返回 InvalidId
+    uint32_t Store(std::string_view name) {
+        if (name.size() > MaxLength) return InvalidId;
+        uint64_t hash = Hash(name);
+        uint32_t tag = (uint32_t)(hash >> 32);
+
+        uint32_t pending = InvalidId;       // 已经写进块里、还没挂到槽位上的条目
+        for (uint32_t slot = (uint32_t)hash & slotMask, probes = 0; probes <= slotMask; slot = (slot + 1) & slotMask, probes++) {
+            uint64_t value = slots[slot].load(std::memory_order_acquire);
+            while (value == 0) {
+                if (count.load(std::memory_order_relaxed) >= (slotMask + 1) / 4 * 3) return InvalidId;
+                if (pending == InvalidId) {
+                    pending = Allocate(name, hash);
+                    if (pending == InvalidId) return InvalidId;
+                }
+                uint64_t mine = (uint64_t)tag << 32 | (pending + 1);
+                if (slots[slot].compare_exchange_strong(value, mine, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    count.fetch_add(1, std::memory_order_relaxed);
+                    return pending;
+                }
+                // 被别的线程抢先：value 已更新为对方的槽位值，下面照常比较
+            }
+            if ((uint32_t)(value >> 32) == tag && Resolve((uint32_t)value - 1) == name) {
+                // 别的线程刚插入了同一个名字：我们分配的条目作废（块里留下几个字节）
+                return (uint32_t)value - 1;
+            }
+        }
+        return InvalidId;
+    }
+
+    // 只查找不插入
+    uint32_t Find(std::string_view name) const {
+        if (name.size() > MaxLength) return InvalidId;
+        uint64_t hash = Hash(name);
+        uint32_t tag = (uint32_t)(hash >> 32);
+        for (uint32_t slot = (uint32_t)hash & slotMask, probes = 0; probes <= slotMask; slot = (slot + 1) & slotMask, probes++) {
+            uint64_t value = slots[slot].load(std::memory_order_acquire);
+            if (value == 0) return InvalidId;
+            if ((uint32_t)(value >> 32) == tag && Resolve((uint32_t)value - 1) == name) return (uint32_t)value - 1;
+        }
+        return InvalidId;
+    }
+
+    // FNameEntryId -> 名字（指向块内存，池存在期间一直有效）；无效 Id 返回空
+    std::string_view Resolve(uint32_t id) const {
+        uint32_t blockIndex = id >> BlockOffsetBits;
+        if (blockIndex >= MaxBlocks) return std::string_view();
+        const uint8_t* block = blocks[blockIndex].load(std::memory_order_acquire);
+        if (!block) return std::string_view();
+        const uint8_t* entry = block + (size_t)(id & 0xFFFF) * Stride;
+        uint16_t header;
+        memcpy(&header, entry, 2);
+        return std::string_view(reinterpret_cast<const char*>(entry + 2), header >> 6);
+    }
+
+    size_t Count() const { return count.load(std::memory_order_relaxed); }
+
+    // 已用的块数（最后一块可能未满）
+    uint32_t BlockCount() const { return (uint32_t)(cursor.load(std::memory_order_acquire) >> 32) + 1; }
+
+    // 块的原始内存（BlockBytes 字节），和游戏里 FNamePool::Blocks[i] 指向的内容格式相同
+    const uint8_t* Block(uint32_t index) const {
+        return index < MaxBlocks ? blocks[index].load(std::memory_order_acquire) : nullptr;
+    }
+
+    // 条目头：长度 << 6 | 小写探测哈希 << 1 | bIsWide
+    static uint16_t MakeHeader(std::string_view name, uint64_t hash) {
+        return (uint16_t)(name.size() << 6 | ((hash >> 58) & 0x1F) << 1);
+    }
+
+    // 条目占用的字节数（含头，按 Stride 对齐）
+    static uint32_t EntryBytes(uint32_t length) {
+        return (2 + length + Stride - 1) / Stride * Stride;
+    }
+
+    static uint64_t Hash(std::string_view name) {
+        uint64_t hash = 0xCBF29CE484222325ULL;      // FNV-1a
+        for (char c : name) {
+            hash ^= (uint8_t)c;
+            hash *= 0x100000001B3ULL;
+        }
+        return hash ^ (hash >> 29);
+    }
+
+private:
+    // 在当前块里划出一个条目并写入内容；当前块放不下时推进到下一块
+    uint32_t Allocate(std::string_view name, uint64_t hash) {
+        uint32_t bytes = EntryBytes((uint32_t)name.size());
+        uint64_t current = cursor.load(std::memory_order_relaxed);
+        uint64_t next;
+        uint32_t blockIndex, offset;
+        do {
+            blockIndex = (uint32_t)(current >> 32);
+            offset = (uint32_t)current;
+            if (offset + bytes > BlockBytes) {
+                blockIndex++;
+                offset = 0;
+            }
+            if (blockIndex >= MaxBlocks) return InvalidId;
+            next = (uint64_t)blockIndex << 32 | (offset + bytes);
+        } while (!cursor.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        uint8_t* block = EnsureBlock(blockIndex);
+        uint8_t* entry = block + offset;
+        uint16_t header = MakeHeader(name, hash);
+        memcpy(entry, &header, 2);
+        memcpy(entry + 2, name.data(), name.size());
+        return blockIndex << BlockOffsetBits | offset / Stride;
+    }
+
+    uint8_t* EnsureBlock(uint32_t index) {
+        uint8_t* block = blocks[index].load(std::memory_order_acquire);
+        if (block) return block;
+        uint8_t* fresh = new uint8_t[BlockBytes]();     // 清零：块尾的空白解析为长度 0
+        if (blocks[index].compare_exchange_strong(block, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) return fresh;
+        delete[] fresh;
+        return block;
+    }
+
+    uint32_t slotMask;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    std::atomic<uint8_t*> blocks[MaxBlocks];
+    std::atomic<uint64_t> cursor{ 0 };          // 当前块号 << 32 | 块内已用字节
+    std::atomic<size_t> count{ 0 };
+};
+
+// 全局名字表（游戏里是 GNames / NamePoolData）
+inline FNamePool& GNames() {
+    static FNamePool pool;
+    return pool;
+}
@@ -0,0 +1,303 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第二课补充：GUObjectArray（全局对象表）
+ * ========================================
+ *
+ * 游戏里所有 UObject 都登记在 GUObjectArray 里，UObject::InternalIndex 就是它在表里的下标。
+ * dump 对象、找所有玩家、找某个类的全部实例，都是从这张表开始遍历。
+ *
+ * UE4.20 之后的内存布局（FUObjectArray）：
+ *   +0x00 ObjFirstGCIndex
+ *   +0x04 ObjLastNonGCIndex
+ *   +0x08 MaxObjectsNotConsideredByGC
+ *   +0x0C OpenForDisregardForGC
+ *   +0x10 ObjObjects（FChunkedFixedUObjectArray）
+ *           +0x00 Objects              FUObjectItem** 块指针数组
+ *           +0x08 PreAllocatedObjects
+ *           +0x10 MaxElements
+ *           +0x14 NumElements
+ *           +0x18 MaxChunks
+ *           +0x1C NumChunks
+ * 每块 64K 个 FUObjectItem，第 i 个对象 = Objects[i / 65536][i % 65536].Object
+ *
+ * 这里按同样的布局模拟，另外加上：
+ * - 空闲链表：对象销毁后下标被复用
+ * - 序列号：下标复用后旧的弱引用（下标 + 序列号）能检测出对象已经不是原来那个
+ * - 每块一列热数据 ClassPrivate：按类过滤时只扫这一列（每个对象 8 字节、连续），
+ *   不去碰一个个分散在堆上的对象本体
+ * - 按块并行遍历
+ *
+ * 分配/释放加锁（UE 也是加锁的）；遍历时不能同时分配（UE 在 GC 锁下遍历）。
+ */
+
+#pragma once
+#include "UETypes.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 对象表中的一项（与 UE 的 FUObjectItem 布局相同，24 字节）
+struct FUObjectItem {
+    UObject* Object;            // +0x00
+    int32_t Flags;              // +0x08
+    int32_t ClusterRootIndex;   // +0x0C
+    int32_t SerialNumber;       // +0x10
+};
+
+struct FChunkedFixedUObjectArray {
+    static constexpr int32_t NumElementsPerChunk = 64 * 1024;
+
+    FUObjectItem** Objects;             // +0x00: 块指针数组
+    FUObjectItem* PreAllocatedObjects;  // +0x08
+    int32_t MaxElements;                // +0x10
+    int32_t NumElements;                // +0x14: 用过的最大下标 + 1（包括已释放的）
+    int32_t MaxChunks;                  // +0x18
+    int32_t NumChunks;                  // +0x1C
+};
+
+// 弱引用：下标 + 序列号
+struct FWeakObjectPtr {
+    int32_t ObjectIndex = -1;
+    int32_t ObjectSerialNumber = 0;
+};
+
+class FUObjectArray {
+public:
+    int32_t ObjFirstGCIndex = 0;                // +0x00
+    int32_t ObjLastNonGCIndex = -1;             // +0x04
+    int32_t MaxObjectsNotConsideredByGC = 0;    // +0x08
+    bool OpenForDisregardForGC = false;         // +0x0C
+    FChunkedFixedUObjectArray ObjObjects;       // +0x10
+
+    static constexpr int32_t ChunkSize = FChunkedFixedUObjectArray::NumElementsPerChunk;
+
+    explicit FUObjectArray(int32_t maxElements = 8 * 1024 * 1024) {
+        int32_t maxChunks = (maxElements + ChunkSize - 1) / ChunkSize;
+        chunkTable.assign(maxChunks, nullptr);
+        classTable.assign(maxChunks, nullptr);
+        ObjObjects.Objects = chunkTable.data();
+        ObjObjects.PreAllocatedObjects = nullptr;
+        ObjObjects.MaxElements = maxElements;
+        ObjObjects.NumElements = 0;
+        ObjObjects.MaxChunks = maxChunks;
+        ObjObjects.NumChunks = 0;
+    }
+
+    ~FUObjectArray() {
+        for (FUObjectItem* chunk : chunkTable) delete[] chunk;
+        for (UClass** chunk : classTable) delete[] chunk;
+    }
+
+    FUObjectArray(const FUObjectArray&) = delete;
+    FUObjectArray& operator=(const FUObjectArray&) = delete;
+
+    // 登记对象：优先复用空闲下标，写回 InternalIndex；表满返回 -1
+    int32_t AllocateUObjectIndex(UObject* object) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int32_t index;
+        if (!freeList.empty()) {
+            index = freeList.back();
+            freeList.pop_back();
+        }
+        else {
+            if (ObjObjects.NumElements >= ObjObjects.MaxElements) return -1;
+            index = ObjObjects.NumElements;
+            if (index / ChunkSize >= ObjObjects.NumChunks) AddChunk();
+            ObjObjects.NumElements++;
+        }
+
+        FUObjectItem& item = Item(index);
+        item.Object = object;
+        item.Flags = 0;
+        item.ClusterRootIndex = 0;
+        item.SerialNumber = ++serialCounter;
+        classTable[index / ChunkSize][index % ChunkSize] = object->ClassPrivate;
+        object->InternalIndex = index;
+        liveCount++;
+        return index;
+    }
+
+    // 对象销毁：清空这一项，下标进空闲链表；序列号清零，旧的弱引用随之失效
+    void FreeUObjectIndex(UObject* object) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int32_t index = object->InternalIndex;
+        if (!IsValidIndex(index) || Item(index).Object != object) return;
+        FUObjectItem& item = Item(index);
+        item.Object = nullptr;
+        item.SerialNumber = 0;
+        classTable[index / ChunkSize][index % ChunkSize] = nullptr;
+        freeList.push_back(index);
+        liveCount--;
+    }
+
+    bool IsValidIndex(int32_t index) const {
+        return index >= 0 && index < ObjObjects.NumElements;
+    }
+
+    FUObjectItem* IndexToObject(int32_t index) {
+        return IsValidIndex(index) ? &Item(index) : nullptr;
+    }
+
+    UObject* GetObjectPtr(int32_t index) const {
+        return IsValidIndex(index) ? Item(index).Object : nullptr;
+    }
+
+    FWeakObjectPtr MakeWeak(const UObject* object) const {
+        FWeakObjectPtr weak;
+        if (object && IsValidIndex(object->InternalIndex) && Item(object->InternalIndex).Object == object) {
+            weak.ObjectIndex = object->InternalIndex;
+            weak.ObjectSerialNumber = Item(object->InternalIndex).SerialNumber;
+        }
+        return weak;
+    }
+
+    // 对象已销毁或下标已被别的对象复用时返回 nullptr
+    UObject* Get(const FWeakObjectPtr& weak) const {
+        if (!IsValidIndex(weak.ObjectIndex)) return nullptr;
+        const FUObjectItem& item = Item(weak.ObjectIndex);
+        return item.SerialNumber == weak.ObjectSerialNumber ? item.Object : nullptr;
+    }
+
+    int32_t Num() const { return ObjObjects.NumElements; }
+    int32_t NumChunks() const { return ObjObjects.NumChunks; }
+    int32_t LiveCount() const { return liveCount; }
+
+    // 顺序遍历所有存活对象：fn(UObject*, int32_t index)
+    template<typename Fn>
+    void ForEachObject(Fn fn) const {
+        for (int32_t c = 0; c < ObjObjects.NumChunks; c++) VisitChunk(c, fn);
+    }
+
+    /*
+     * 按块并行：每块是一个任务，线程从共享计数器领取下一块
+     * fn 会被多个线程同时调用（threads 为 0 时使用全部核心）
+     */
+    template<typename Fn>
+    void ParallelForEachObject(Fn fn, unsigned threads = 0) const {
+        ParallelForEachChunk([this, &fn](int32_t chunk) { VisitChunk(chunk, fn); }, threads);
+    }
+
+    template<typename Fn>
+    void ParallelForEachChunk(Fn fn, unsigned threads = 0) const {
+        int32_t chunks = ObjObjects.NumChunks;
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+        if ((int32_t)threads > chunks) threads = chunks > 0 ? (unsigned)chunks : 1;
+
+        std::atomic<int32_t> next{ 0 };
+        auto worker = [&]() {
+            for (int32_t c = next.fetch_add(1); c < chunks; c = next.fetch_add(1)) fn(c);
+        };
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; t++) pool.emplace_back(worker);
+        worker();
+        for (auto& th : pool) th.join();
+    }
+
+    /*
+     * 按类过滤：match(UClass*) 只看 ClassPrivate 列，命中的才去取对象
+     * 例：ForEachObjectOfClass([&](UClass* c) { return c == playerClass; }, fn)
+     *     包括子类：[&](UClass* c) { return c->IsChildOf(pawnClass); }（类登记到 FClassTree 后是两次比较）
+     */
+    template<typename Match, typename Fn>
+    void ForEachObjectOfClass(Match match, Fn fn) const {
+        for (int32_t c = 0; c < ObjObjects.NumChunks; c++) VisitChunkOfClass(c, match, fn);
+    }
+
+    template<typename Match, typename Fn>
+    void ParallelForEachObjectOfClass(Match match, Fn fn, unsigned threads = 0) const {
+        ParallelForEachChunk([&](int32_t chunk) { VisitChunkOfClass(chunk, match, fn); }, threads);
+    }
+
+    /*
+     * 迭代器写法（类似 TObjectIterator）：
+     *   for (auto it = GUObjectArray().FilterByClass(match); it; ++it) { UObject* object = *it; }
+     */
+    template<typename Match>
+    class TClassIterator {
+    public:
+        TClassIterator(const FUObjectArray& array, Match match) : array(array), match(match) { Advance(); }
+
+        explicit operator bool() const { return index < array.ObjObjects.NumElements; }
+        UObject* operator*() const { return array.Item(index).Object; }
+        int32_t GetIndex() const { return index; }
+
+        TClassIterator& operator++() {
+            index++;
+            Advance();
+            return *this;
+        }
+
+    private:
+        // 只读 ClassPrivate 列，跳过空项和不匹配的项
+        void Advance() {
+            int32_t num = array.ObjObjects.NumElements;
+            while (index < num) {
+                UClass* const* classes = array.classTable[index / ChunkSize];
+                int32_t end = (index / ChunkSize + 1) * ChunkSize;
+                if (end > num) end = num;
+                for (; index < end; index++) {
+                    UClass* cls = classes[index % ChunkSize];
+                    if (cls && match(cls)) return;
+                }
+            }
+        }
+
+        const FUObjectArray& array;
+        Match match;
+        int32_t index = 0;
+    };
+
+    template<typename Match>
+    TClassIterator<Match> FilterByClass(Match match) const {
+        return TClassIterator<Match>(*this, match);
+    }
+
+private:
+    FUObjectItem& Item(int32_t index) const {
+        return chunkTable[index / ChunkSize][index % ChunkSize];
+    }
+
+    void AddChunk() {
+        int32_t chunk = ObjObjects.NumChunks;
+        chunkTable[chunk] = new FUObjectItem[ChunkSize]();
+        classTable[chunk] = new UClass*[ChunkSize]();
+        ObjObjects.NumChunks++;
+    }
+
+    template<typename Fn>
+    void VisitChunk(int32_t chunk, Fn& fn) const {
+        int32_t begin = chunk * ChunkSize;
+        int32_t end = begin + ChunkSize < ObjObjects.NumElements ? begin + ChunkSize : ObjObjects.NumElements;
+        const FUObjectItem* items = chunkTable[chunk];
+        for (int32_t i = begin; i < end; i++) {
+            if (UObject* object = items[i - begin].Object) fn(object, i);
+        }
+    }
+
+    template<typename Match, typename Fn>
+    void VisitChunkOfClass(int32_t chunk, Match& match, Fn& fn) const {
+        int32_t begin = chunk * ChunkSize;
+        int32_t end = begin + ChunkSize < ObjObjects.NumElements ? begin + ChunkSize : ObjObjects.NumElements;
+        UClass* const* classes = classTable[chunk];
+        for (int32_t i = begin; i < end; i++) {
+            UClass* cls = classes[i - begin];
+            if (cls && match(cls)) fn(chunkTable[chunk][i - begin].Object, i);
+        }
+    }
+
+    std::vector<FUObjectItem*> chunkTable;      // ObjObjects.Objects 指向这里
+    std::vector<UClass**> classTable;           // 每块一列 ClassPrivate（登记时写入）
+    std::vector<int32_t> freeList;
+    std::mutex mutex;
+    int32_t serialCounter = 0;
+    int32_t liveCount = 0;
+};
+
+// 全局对象表
+inline FUObjectArray& GUObjectArray() {
+    static FUObjectArray array;
+    return array;
+}
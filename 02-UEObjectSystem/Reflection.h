@@ -0,0 +1,263 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第二课补充：反射属性表
+ * ========================================
+ *
+ * UETypes.h 里的偏移都写在注释里（RootComponent +0x130、RelativeLocation +0x120），
+ * 游戏更新后要重新找。其实引擎自己就带着答案：每个类的反射信息里
+ * 存着所有属性的名字、类型和偏移（SDK 生成器就是靠这个 dump 出偏移的）。
+ *
+ * UE4.25+ 的结构（UETypes.h 按同样的关系模拟，UClass 继承自 UStruct）：
+ *   UStruct
+ *     SuperStruct       -> 父类的 UStruct
+ *     ChildProperties   -> FField 链表（只有本类声明的属性，不含父类的）
+ *   FField
+ *     Next              -> 下一个属性
+ *     NamePrivate       -> 属性名（FName）
+ *   FProperty : FField
+ *     ArrayDim / ElementSize / PropertyFlags / Offset_Internal
+ *     类型：引擎里靠 FFieldClass 区分（FObjectProperty、FStructProperty……），这里简化为枚举
+ *
+ * 直接按名字找偏移要沿 SuperStruct 逐层走链表、逐个比较名字。
+ * FPropertyLayoutIndex 给每个类构建一张表：
+ * 1. 把本类和所有父类的属性摊平到一个数组（子类同名属性遮住父类的）
+ * 2. 用"哈希 + 位移"（hash and displace）构建完美哈希：
+ *    名字先落到一个桶，每个桶选一个位移值，使所有名字落到互不冲突的槽位
+ * 3. 查找 = 算一次哈希 + 读位移 + 读槽位 + 比较一次名字，不会探测
+ * 表按需构建并缓存，新类第一次查询时才构建（增量）。
+ */
+
+#pragma once
+#include "UETypes.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// ====================================
+// 第一部分：摊平 + 完美哈希
+// ====================================
+
+// 一个类（含继承）的全部属性
+class FPropertyTable {
+public:
+    struct Entry {
+        FName Name;
+        int32_t Offset;
+        int32_t ElementSize;
+        int32_t ArrayDim;
+        EPropertyType Type;
+        const UStruct* Owner;           // 声明这个属性的类（可能是父类）
+        const FProperty* Property;
+    };
+
+    // 找不到返回 nullptr
+    const Entry* Find(std::string_view name) const {
+        if (entries.empty()) return nullptr;
+        uint64_t hash = Hash(name);
+        uint32_t displacement = displacements[(uint32_t)(hash >> 32) % (uint32_t)displacements.size()];
+        uint32_t slot = slots[Slot(hash, displacement, slotMask)];
+        if (slot == Empty) return nullptr;
+        const Entry& entry = entries[slot];
+        return entry.Name.GetName() == name ? &entry : nullptr;
+    }
+
+    int32_t Offset(std::string_view name, int32_t fallback = -1) const {
+        const Entry* entry = Find(name);
+        return entry ? entry->Offset : fallback;
+    }
+
+    const std::vector<Entry>& Entries() const { return entries; }
+    size_t Size() const { return entries.size(); }
+
+    // 本类 + 所有父类的属性 -> 表
+    bool Build(const UStruct* cls) {
+        entries.clear();
+
+        // 从本类往上：先出现的名字优先（子类同名属性遮住父类的，与逐层查找的结果一致）
+        std::unordered_map<std::string_view, size_t> seen;
+        for (const UStruct* s = cls; s; s = s->SuperStruct) {
+            for (const FField* field = s->ChildProperties; field; field = field->Next) {
+                const FProperty* property = static_cast<const FProperty*>(field);
+                if (!seen.emplace(property->NamePrivate.GetName(), entries.size()).second) continue;
+                entries.push_back({ property->NamePrivate, property->Offset_Internal, property->ElementSize,
+                                    property->ArrayDim, property->Type, s, property });
+            }
+        }
+        return BuildHash();
+    }
+
+private:
+    static constexpr uint32_t Empty = 0xFFFFFFFF;
+    static constexpr uint32_t MaxDisplacement = 1u << 16;
+
+    static uint64_t Hash(std::string_view name) {
+        uint64_t hash = 0xCBF29CE484222325ULL;      // FNV-1a
+        for (char c : name) {
+            hash ^= (uint8_t)c;
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    static uint32_t Slot(uint64_t hash, uint32_t displacement, uint32_t mask) {
+        uint64_t x = hash ^ (displacement * 0x9E3779B97F4A7C15ULL);
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDULL;
+        x ^= x >> 33;
+        return (uint32_t)x & mask;
+    }
+
+    /*
+     * 哈希 + 位移：约 4 个名字一个桶，大桶先放；
+     * 每个桶从 0 开始试位移值，直到桶里的名字都落到空槽位（槽位数约为名字数的 1.25~2.5 倍）
+     * 极少数情况下找不到时把槽位数翻倍重来
+     */
+    bool BuildHash() {
+        size_t count = entries.size();
+        uint32_t bucketCount = (uint32_t)(count / 4 + 1);
+        uint32_t slotCount = 1;
+        while (slotCount < count + count / 4 + 1) slotCount <<= 1;
+
+        std::vector<uint64_t> hashes(count);
+        for (size_t i = 0; i < count; i++) hashes[i] = Hash(entries[i].Name.GetName());
+
+        std::vector<std::vector<uint32_t>> buckets(bucketCount);
+        for (uint32_t i = 0; i < count; i++) buckets[(uint32_t)(hashes[i] >> 32) % bucketCount].push_back(i);
+        std::vector<uint32_t> order(bucketCount);
+        for (uint32_t b = 0; b < bucketCount; b++) order[b] = b;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        for (int attempt = 0; attempt < 8; attempt++, slotCount <<= 1) {
+            slotMask = slotCount - 1;
+            slots.assign(slotCount, Empty);
+            displacements.assign(bucketCount, 0);
+            bool ok = true;
+
+            for (uint32_t b : order) {
+                const std::vector<uint32_t>& bucket = buckets[b];
+                if (bucket.empty()) break;      // 排过序，后面都是空桶
+
+                uint32_t d = 0;
+                for (; d < MaxDisplacement; d++) {
+                    bool fits = true;
+                    for (size_t k = 0; k < bucket.size() && fits; k++) {
+                        uint32_t slot = Slot(hashes[bucket[k]], d, slotMask);
+                        if (slots[slot] != Empty) fits = false;
+                        for (size_t j = 0; j < k && fits; j++) {
+                            if (Slot(hashes[bucket[j]], d, slotMask) == slot) fits = false;   // 同一个桶内互相冲突
+                        }
+                    }
+                    if (fits) break;
+                }
+                if (d == MaxDisplacement) {
+                    ok = false;
+                    break;
+                }
+                displacements[b] = d;
+                for (uint32_t index : bucket) slots[Slot(hashes[index], d, slotMask)] = index;
+            }
+            if (ok) return true;
+        }
+        entries.clear();
+        slots.clear();
+        displacements.clear();
+        return false;
+    }
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> slots;            // 槽位 -> entries 下标
+    std::vector<uint32_t> displacements;    // 桶 -> 位移值
+    uint32_t slotMask = 0;
+};
+
+// 所有类的属性表缓存：第一次查询某个类时构建
+class FPropertyLayoutIndex {
+public:
+    const FPropertyTable& Get(const UStruct* cls) {
+        auto found = tables.find(cls);
+        if (found != tables.end()) return *found->second;
+        std::unique_ptr<FPropertyTable> table(new FPropertyTable());
+        table->Build(cls);
+        return *tables.emplace(cls, std::move(table)).first->second;
+    }
+
+    // 类 + 属性名 -> 偏移，找不到返回 fallback
+    int32_t Offset(const UStruct* cls, std::string_view name, int32_t fallback = -1) {
+        return Get(cls).Offset(name, fallback);
+    }
+
+    // 类的属性有改动（热重载）：丢掉它和子类的表，下次查询时重建
+    void Invalidate(const UStruct* cls) {
+        for (auto it = tables.begin(); it != tables.end();) {
+            bool affected = false;
+            for (const UStruct* s = it->first; s && !affected; s = s->SuperStruct) affected = s == cls;
+            it = affected ? tables.erase(it) : std::next(it);
+        }
+    }
+
+    size_t Num() const { return tables.size(); }
+
+private:
+    std::unordered_map<const UStruct*, std::unique_ptr<FPropertyTable>> tables;
+};
+
+// ====================================
+// 使用示例
+// ====================================
+
+namespace UEExample {
+
+    // 用反射信息代替硬编码偏移
+    inline void Demo_PropertyLookup() {
+        std::cout << "\n=== 反射属性表：按名字查偏移 ===" << std::endl;
+
+        // 引擎启动时注册的反射信息（这里手工搭一份，偏移取 UETypes.h 注释里的值）
+        static UClass objectClass, actorClass, pawnClass, sceneComponentClass;
+        static FProperty rootComponent("RootComponent", EPropertyType::Object, 0x130, 8);
+        static FProperty playerState("PlayerState", EPropertyType::Object, 0x240, 8);
+        static FProperty relativeLocation("RelativeLocation", EPropertyType::Struct, 0x120, 12);
+        static FProperty relativeRotation("RelativeRotation", EPropertyType::Struct, 0x12C, 12);
+
+        if (!actorClass.SuperStruct) {
+            objectClass.NamePrivate = FName("Object");
+            actorClass.NamePrivate = FName("Actor");
+            actorClass.SuperStruct = &objectClass;
+            actorClass.AddProperty(&rootComponent);
+            pawnClass.NamePrivate = FName("Pawn");
+            pawnClass.SuperStruct = &actorClass;
+            pawnClass.AddProperty(&playerState);
+            sceneComponentClass.NamePrivate = FName("SceneComponent");
+            sceneComponentClass.SuperStruct = &objectClass;
+            sceneComponentClass.AddProperty(&relativeLocation);
+            sceneComponentClass.AddProperty(&relativeRotation);
+        }
+
+        // APawn 的表里也有从 AActor 继承的 RootComponent
+        FPropertyLayoutIndex layouts;
+        const FPropertyTable& pawnTable = layouts.Get(&pawnClass);
+        std::cout << "APawn 的属性（含父类）: " << pawnTable.Size() << " 个" << std::endl;
+        for (size_t i = 0; i < pawnTable.Size(); i++) {
+            const FPropertyTable::Entry& entry = pawnTable.Entries()[i];
+            std::cout << (i + 1 == pawnTable.Size() ? "   └─ " : "   ├─ ") << entry.Name.GetName() << "  +0x" << std::hex << entry.Offset << std::dec
+                      << "  (声明在 " << entry.Owner->NamePrivate.GetName() << ")" << std::endl;
+        }
+
+        // 启动时查一次，之后当普通常量用
+        int32_t OFFSET_RootComponent = layouts.Offset(&pawnClass, "RootComponent");
+        int32_t OFFSET_RelativeLocation = layouts.Offset(&sceneComponentClass, "RelativeLocation");
+        int32_t OFFSET_Missing = layouts.Offset(&pawnClass, "RelativeLocation");
+        std::cout << "Pawn.RootComponent:              +0x" << std::hex << OFFSET_RootComponent << std::dec << std::endl;
+        std::cout << "SceneComponent.RelativeLocation: +0x" << std::hex << OFFSET_RelativeLocation << std::dec << std::endl;
+        std::cout << "Pawn.RelativeLocation:           " << OFFSET_Missing << "（APawn 没有这个属性）" << std::endl;
+        std::cout << "已构建的属性表: " << layouts.Num() << " 个" << std::endl;
+
+        // 读取：
+        // uintptr_t RootComponent = *(uintptr_t*)(Pawn + OFFSET_RootComponent);
+        // FVector Location = *(FVector*)(RootComponent + OFFSET_RelativeLocation);
+    }
+}
@@ -8,11 +8,15 @@
  */
 
 #pragma once
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <string>
 #include <vector>
 #include <cstdint>
 #include <cmath>
+#include <string_view>
+#include "NamePool.h"
 
 // ====================================
 // 第一部分：FName - UE的名称系统
@@ -22,17 +26,29 @@
  * 知识点：FName
  * - UE中用于快速比较字符串的系统
  * - 使用索引而不是字符串比较，性能更高
- * - 所有FName存储在GNames全局表中
+ * - 所有FName存储在GNames全局表中（块 + 偏移，见 NamePool.h）
  */
 struct FName {
-    int32_t Index;      // 在GNames表中的索引
+    int32_t Index;      // 在GNames表中的索引（块号 << 16 | 块内偏移 / 2）
     int32_t Number;     // 实例编号（如多个同名对象）
     
+    FName() : Index(0), Number(0) {}    // NAME_None
+    
+    // 相当于引擎的 FName(TEXT("...")) ：查找或插入 GNames
+    explicit FName(std::string_view name, int32_t number = 0)
+        : Index((int32_t)GNames().Store(name)), Number(number) {}
+    
     // 在实际逆向中，我们需要通过这个函数获取真实名称
-    std::string GetName() {
+    // 这里直接按 Index 算出块内地址，返回指向名字表的 string_view，不分配内存
+    // （Number 不为 0 时引擎显示为 "Name_(Number-1)"，需要时由调用方拼接）
+    std::string_view GetName() const {
         // 实际游戏中会调用引擎的GetName函数
         // 地址类似: 游戏基址 + 0x12345678
-        return "ExampleName_" + std::to_string(Index);
+        return GNames().Resolve((uint32_t)Index);
+    }
+    
+    bool operator==(const FName& other) const {
+        return Index == other.Index && Number == other.Number;
     }
 };
 
@@ -124,8 +140,11 @@ public:
     FName NamePrivate;      // +0x18: 对象名称
     UObject* OuterPrivate;  // +0x20: 外部对象（所有者）
     
+    // 是否是 base 类（或其子类）的实例，定义在 UClass 之后
+    bool IsA(const UClass* base) const;
+    
     // 获取对象名称
-    virtual std::string GetName() {
+    virtual std::string_view GetName() {
         return NamePrivate.GetName();
     }
     
@@ -139,20 +158,117 @@ public:
 };
 
 // ====================================
-// 第五部分：UClass - 类型信息
+// 第五部分：UStruct / UClass - 反射与类型信息
 // ====================================
 
+/*
+ * 知识点：UStruct / FProperty - 反射信息
+ * - UClass 继承自 UStruct：父类（SuperStruct）和属性链表都在 UStruct 里
+ * - UE4.25+ 的属性是 FField 链表（之前是 UProperty），每个属性带名字、类型和偏移
+ * - SDK 生成器就是沿这些链表 dump 出偏移的；按名字快速查找见 Reflection.h
+ */
+enum class EPropertyType : uint8_t {
+    Unknown,
+    Bool,
+    Byte,
+    Int,
+    Int64,
+    Float,
+    Double,
+    Name,
+    Str,
+    Object,     // UObject* 指针
+    Struct,     // 内嵌结构体（FVector、FRotator……）
+    Array       // TArray
+};
+
+class FField {
+public:
+    FField* Next = nullptr;         // 同一个类里的下一个属性
+    FName NamePrivate;              // 属性名
+};
+
+class FProperty : public FField {
+public:
+    int32_t ArrayDim = 1;           // 静态数组长度（int32 Ammo[4] 为 4）
+    int32_t ElementSize = 0;
+    uint64_t PropertyFlags = 0;
+    int32_t Offset_Internal = 0;    // 在对象里的偏移
+    EPropertyType Type = EPropertyType::Unknown;
+
+    FProperty() = default;
+    FProperty(std::string_view name, EPropertyType type, int32_t offset, int32_t size)
+        : ElementSize(size), Offset_Internal(offset), Type(type) {
+        NamePrivate = FName(name);
+    }
+};
+
+class UStruct : public UObject {
+public:
+    UStruct* SuperStruct = nullptr;         // 父类
+    FField* ChildProperties = nullptr;      // 本类声明的属性（不含父类）
+    int32_t PropertiesSize = 0;             // 对象大小
+
+    // 把属性接到链表末尾（引擎里由反射代码在启动时注册）
+    void AddProperty(FProperty* property) {
+        FField** tail = &ChildProperties;
+        while (*tail) tail = &(*tail)->Next;
+        property->Next = nullptr;
+        *tail = property;
+        int32_t end = property->Offset_Internal + property->ElementSize * property->ArrayDim;
+        if (end > PropertiesSize) PropertiesSize = end;
+    }
+
+    // 逐层逐个比较名字（对照用，FPropertyLayoutIndex 就是为了替代它）
+    const FProperty* FindPropertyByWalk(std::string_view name) const {
+        for (const UStruct* s = this; s; s = s->SuperStruct) {
+            for (const FField* field = s->ChildProperties; field; field = field->Next) {
+                if (field->NamePrivate.GetName() == name) return static_cast<const FProperty*>(field);
+            }
+        }
+        return nullptr;
+    }
+};
+
 /*
  * 知识点：UClass
  * - 描述UObject的类型
  * - 包含类的成员变量、函数等信息
+ * - IsA 判断：沿 SuperStruct 一路往上找要走好几层；
+ *   UE5 给每个类存一条按深度索引的父类链（FStructBaseChain），
+ *   Chain[0] 是根类，Chain[深度] 是自己，IsA 只要两次比较（链由 ClassTree.h 生成）
  */
-class UClass : public UObject {
+class UClass : public UStruct {
 public:
     // 这里简化，实际更复杂
-    UClass* SuperClass;  // 父类
+    
+    UClass** StructBaseChainArray = nullptr;        // 父类链（未登记时为空）
+    int32_t NumStructBasesInChainMinusOne = -1;     // 深度
+    
+    // 父类（UClass 的 SuperStruct 一定是 UClass）
+    UClass* GetSuperClass() const {
+        return static_cast<UClass*>(SuperStruct);
+    }
+    
+    // 自己是否是 base 或 base 的子类
+    bool IsChildOf(const UClass* base) const {
+        if (!base) return false;
+        if (StructBaseChainArray && base->StructBaseChainArray) {
+            int32_t depth = base->NumStructBasesInChainMinusOne;
+            return depth <= NumStructBasesInChainMinusOne && StructBaseChainArray[depth] == base;
+        }
+        // 没登记过的类：沿 SuperStruct 逐层比较
+        for (const UClass* cls = this; cls; cls = cls->GetSuperClass()) {
+            if (cls == base) return true;
+        }
+        return false;
+    }
 };
 
+inline bool UObject::IsA(const UClass* base) const {
+    return ClassPrivate && ClassPrivate->IsChildOf(base);
+}
+
 // ====================================
 // 第六部分：AActor - 游戏对象
 // ====================================
@@ -173,6 +289,7 @@ public:
     
     // 在DeltaForce中，你需要找到这些偏移：
     // RootComponent的偏移可能是 +0x130
+    // （也可以从引擎的反射信息里按名字查，见 Reflection.h）
 };
 
 // ====================================
@@ -0,0 +1,195 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：TArray 批量按列读取
+ * ========================================
+ *
+ * 遍历 TArray<APlayerState*> 再读每个元素的 PlayerId、TeamId、PlayerName，
+ * 逐个读就是 N 个元素 × M 个字段次指针追踪。这里改成固定的几轮批量读取：
+ *
+ * 1. 读 TArray 头（Data + Count + Max）                      —— 1 次
+ * 2. 一次读出整个指针块 Data[0..Count)                        —— 1 次
+ * 3. 元素地址排序去重，每个元素只读"最小偏移到最大偏移"这一段，
+ *    交给 ScatterRead 合并成整页读取                          —— 段数次（对象在堆上挨得近时很少）
+ * 4. 拆到按列存放的数组里（SoA）：同一个字段的所有值连续存放，
+ *    后面按字段过滤、排序时缓存友好
+ *
+ * 布局按 UETypes.h / SimulatedGame.h 的 TArray：
+ *   +0x00 Data 指针 | +ptr Count int32 | +ptr+4 Max int32
+ */
+
+#pragma once
+#include "ScatterRead.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// 按列存放的读取结果：行号就是数组下标
+class ArrayColumns {
+public:
+    size_t Rows() const { return elements.size(); }
+    size_t Columns() const { return columns.size(); }
+
+    // 第 row 个元素的地址（空指针元素为 0）
+    uint64_t Element(size_t row) const { return elements[row]; }
+    const std::vector<uint64_t>& Elements() const { return elements; }
+
+    // 这一行的字段是否都读到了（空指针或读失败的元素为 false，字段全为 0）
+    bool Valid(size_t row) const { return valid[row] != 0; }
+
+    // 第 column 列，连续 Rows() 个 T
+    template<typename T>
+    const T* Column(size_t column) const {
+        return reinterpret_cast<const T*>(columns[column].data());
+    }
+
+    // 字符串字段（固定长度的 char 数组，如 PlayerName）
+    const char* Text(size_t column, size_t row) const {
+        return reinterpret_cast<const char*>(columns[column].data() + row * widths[column]);
+    }
+
+private:
+    friend class ArrayReader;
+
+    std::vector<uint64_t> elements;
+    std::vector<uint8_t> valid;
+    std::vector<std::vector<uint8_t>> columns;
+    std::vector<uint32_t> widths;
+};
+
+class ArrayReader {
+public:
+    struct Stats {
+        size_t elements = 0;        // 非空元素（去重后）
+        size_t calls = 0;           // 总读取调用次数
+    };
+
+    // 用任意读取函数（快照文件、dump、ReadProcessMemory 包装）
+    explicit ArrayReader(ScatterRead::RangeReader read, size_t pointerBytes = sizeof(uintptr_t))
+        : reader(std::move(read)), pointerSize(pointerBytes) {}
+
+    // 直接读进程（pid 为 0 表示当前进程），字段读取走 ScatterRead::ExecuteProcess
+    static ArrayReader ForProcess(uint32_t pid = 0, size_t pointerBytes = sizeof(uintptr_t)) {
+        ArrayReader result(nullptr, pointerBytes);
+        result.pid = pid;
+        return result;
+    }
+
+    // 登记要读的字段，返回列号
+    size_t AddField(uint32_t offset, uint32_t size) {
+        fields.push_back({ offset, size });
+        return fields.size() - 1;
+    }
+
+    template<typename T>
+    size_t AddField(uint32_t offset) {
+        return AddField(offset, (uint32_t)sizeof(T));
+    }
+
+    /*
+     * 读 arrayAddress 处的 TArray（元素是指针）
+     * Count 为负、超过 Max 或超过 maxCount 时认为数组无效（多半是偏移错了）
+     */
+    bool Read(uint64_t arrayAddress, ArrayColumns& out, uint32_t maxCount = 1u << 20) {
+        stats = Stats();
+        out.elements.clear();
+        out.valid.clear();
+        out.columns.assign(fields.size(), std::vector<uint8_t>());
+        out.widths.resize(fields.size());
+        for (size_t c = 0; c < fields.size(); c++) out.widths[c] = fields[c].size;
+
+        // 1. 数组头
+        uint8_t header[16] = {};
+        ScatterRead batch;
+        size_t headerSize = pointerSize + 8;
+        batch.Add(arrayAddress, header, headerSize);
+        if (!Run(batch)) return false;
+
+        uint64_t data = 0;
+        int32_t count = 0, capacity = 0;
+        memcpy(&data, header, pointerSize);
+        memcpy(&count, header + pointerSize, 4);
+        memcpy(&capacity, header + pointerSize + 4, 4);
+        if (count < 0 || count > capacity || (uint32_t)count > maxCount) return false;
+        if (count == 0) return true;
+        if (!data) return false;
+
+        // 2. 整个指针块
+        std::vector<uint8_t> block((size_t)count * pointerSize);
+        batch.Clear();
+        batch.Add(data, block.data(), block.size());
+        if (!Run(batch)) return false;
+
+        out.elements.resize(count);
+        for (int32_t i = 0; i < count; i++) {
+            uint64_t element = 0;
+            memcpy(&element, block.data() + (size_t)i * pointerSize, pointerSize);
+            out.elements[i] = element;
+        }
+        out.valid.assign(count, 0);
+        for (size_t c = 0; c < fields.size(); c++) out.columns[c].assign((size_t)count * fields[c].size, 0);
+        if (fields.empty()) {
+            for (int32_t i = 0; i < count; i++) out.valid[i] = out.elements[i] != 0;
+            return true;
+        }
+
+        // 3. 元素地址排序去重，每个元素读一段 [minOffset, maxEnd)
+        uint32_t low = fields[0].offset, high = 0;
+        for (const Field& f : fields) {
+            if (f.offset < low) low = f.offset;
+            if (f.offset + f.size > high) high = f.offset + f.size;
+        }
+        size_t slice = high - low;
+
+        std::vector<uint64_t> unique;
+        unique.reserve(count);
+        for (uint64_t element : out.elements) {
+            if (element) unique.push_back(element);
+        }
+        std::sort(unique.begin(), unique.end());
+        unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+        stats.elements = unique.size();
+
+        std::vector<uint8_t> staging(unique.size() * slice);
+        batch.Clear();
+        for (size_t u = 0; u < unique.size(); u++) {
+            batch.Add(unique[u] + low, staging.data() + u * slice, slice);
+        }
+        Run(batch);
+
+        // 4. 拆成列（重复出现的元素共用同一份数据）
+        for (int32_t i = 0; i < count; i++) {
+            uint64_t element = out.elements[i];
+            if (!element) continue;
+            size_t u = std::lower_bound(unique.begin(), unique.end(), element) - unique.begin();
+            if (!batch.Succeeded(u)) continue;
+            const uint8_t* src = staging.data() + u * slice;
+            for (size_t c = 0; c < fields.size(); c++) {
+                memcpy(out.columns[c].data() + (size_t)i * fields[c].size, src + (fields[c].offset - low), fields[c].size);
+            }
+            out.valid[i] = 1;
+        }
+        return true;
+    }
+
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct Field {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    // 执行一轮批量读取，返回是否全部成功
+    bool Run(ScatterRead& batch) {
+        size_t ok = reader ? batch.Execute(reader) : batch.ExecuteProcess(pid);
+        stats.calls += batch.GetStats().calls;
+        return ok == batch.Size();
+    }
+
+    ScatterRead::RangeReader reader;
+    size_t pointerSize;
+    uint32_t pid = 0;
+    std::vector<Field> fields;
+    Stats stats;
+};
@@ -0,0 +1,112 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：快速内容哈希
+ * ========================================
+ *
+ * 判断"游戏文件有没有更新"、"这一页内存有没有变"都需要对大块数据做哈希。
+ * 这里实现 XXH64（xxHash 64 位版本）：
+ * - 每次处理 32 字节，4 路并行累加，速度接近内存带宽
+ * - 不是密码学哈希，只用来判断内容是否变化
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace FastHash {
+
+    constexpr uint64_t Prime1 = 11400714785074694791ULL;
+    constexpr uint64_t Prime2 = 14029467366897019727ULL;
+    constexpr uint64_t Prime3 = 1609587929392839161ULL;
+    constexpr uint64_t Prime4 = 9650029242287828579ULL;
+    constexpr uint64_t Prime5 = 2870177450012600261ULL;
+
+    inline uint64_t RotateLeft(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline uint64_t Read64(const uint8_t* p) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint32_t Read32(const uint8_t* p) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint64_t Round(uint64_t acc, uint64_t input) {
+        acc += input * Prime2;
+        acc = RotateLeft(acc, 31);
+        return acc * Prime1;
+    }
+
+    inline uint64_t MergeRound(uint64_t acc, uint64_t value) {
+        acc ^= Round(0, value);
+        return acc * Prime1 + Prime4;
+    }
+
+    /*
+     * 官方 xxHash 的参考值（seed = 0），改动实现后用来核对：
+     *   ""                                         -> 0xEF46DB3751D8E999
+     *   "abc"                                      -> 0x44BC2CF5AD770999
+     *   "Nobody inspects the spammish repetition"  -> 0xFBCEA83C8A378BF1（39 字节，走 32 字节分组）
+     */
+    inline uint64_t XXH64(const void* input, size_t length, uint64_t seed = 0) {
+        const uint8_t* p = (const uint8_t*)input;
+        const uint8_t* end = p + length;
+        uint64_t h;
+
+        if (length >= 32) {
+            uint64_t v1 = seed + Prime1 + Prime2;
+            uint64_t v2 = seed + Prime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - Prime1;
+            const uint8_t* limit = end - 32;
+            do {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            h = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+            h = MergeRound(h, v1);
+            h = MergeRound(h, v2);
+            h = MergeRound(h, v3);
+            h = MergeRound(h, v4);
+        }
+        else {
+            h = seed + Prime5;
+        }
+
+        h += (uint64_t)length;
+
+        while (p + 8 <= end) {
+            h ^= Round(0, Read64(p));
+            h = RotateLeft(h, 27) * Prime1 + Prime4;
+            p += 8;
+        }
+        if (p + 4 <= end) {
+            h ^= (uint64_t)Read32(p) * Prime1;
+            h = RotateLeft(h, 23) * Prime2 + Prime3;
+            p += 4;
+        }
+        while (p < end) {
+            h ^= (*p) * Prime5;
+            h = RotateLeft(h, 11) * Prime1;
+            p++;
+        }
+
+        h ^= h >> 33;
+        h *= Prime2;
+        h ^= h >> 29;
+        h *= Prime3;
+        h ^= h >> 32;
+        return h;
+    }
+}
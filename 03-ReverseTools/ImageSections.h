@@ -0,0 +1,397 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：按区段扫描（PE / ELF）
+ * ========================================
+ *
+ * 一个模块里真正有代码的只有 .text，
+ * 数据(.data)、资源(.rsrc)、重定位(.reloc) 占了大半体积，
+ * 代码特征码在那里永远不会命中。
+ *
+ * 本文件：
+ * 1. 解析 PE（Windows exe/dll）和 ELF（Linux）的区段表
+ * 2. 每个特征码声明自己所在的区段，比如 ".text"、".rdata"
+ * 3. 扫描时只遍历声明的区段
+ *
+ * 不依赖 windows.h，Linux 上可以直接拿磁盘上的文件测试。
+ */
+
+#pragma once
+#include "PatternScan.h"
+#include "MultiPatternScan.h"
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+namespace ImageFormat {
+
+    // ====================================
+    // 第一部分：区段表
+    // ====================================
+
+    enum class ImageKind {
+        Unknown,
+        PE,
+        ELF
+    };
+
+    struct Section {
+        std::string name;
+        uint64_t virtualAddress = 0;  // 加载后相对模块基址的偏移（PE 的 RVA / ELF 的 sh_addr）
+        uint64_t virtualSize = 0;
+        uint64_t fileOffset = 0;      // 在磁盘文件中的偏移
+        uint64_t fileSize = 0;        // 在磁盘文件中的大小（.bss 为 0）
+        bool executable = false;
+        bool writable = false;
+    };
+
+    /*
+     * 数据来源有两种布局：
+     * - 文件布局：直接读磁盘上的 exe/so，区段位于 fileOffset
+     * - 内存布局：模块已被加载（GetModuleHandle），区段位于 virtualAddress
+     */
+    enum class Layout {
+        File,
+        Mapped
+    };
+
+    struct ImageLayout {
+        ImageKind kind = ImageKind::Unknown;
+        uint64_t imageBase = 0;       // 首选加载地址（ELF 为 0）
+        std::vector<Section> sections;
+
+        const Section* Find(const char* name) const {
+            for (const auto& section : sections) {
+                if (section.name == name) return &section;
+            }
+            return nullptr;
+        }
+    };
+
+    // 小端读取（PE/ELF 在 x86/x64 上都是小端）
+    template<typename T>
+    inline bool ReadField(const uint8_t* data, size_t size, uint64_t offset, T& out) {
+        if (offset > size || sizeof(T) > size - offset) return false;
+        memcpy(&out, data + offset, sizeof(T));
+        return true;
+    }
+
+    // ====================================
+    // 第二部分：PE 解析
+    // ====================================
+
+    /*
+     * PE 结构速记：
+     * +0x00 IMAGE_DOS_HEADER.e_magic = "MZ"
+     * +0x3C e_lfanew -> "PE\0\0"
+     *       +0x04 IMAGE_FILE_HEADER（20 字节，NumberOfSections 在 +0x02，SizeOfOptionalHeader 在 +0x10）
+     *       +0x18 IMAGE_OPTIONAL_HEADER（ImageBase 在 +0x18 / +0x1C）
+     *       之后是 IMAGE_SECTION_HEADER 数组，每项 40 字节
+     */
+    inline bool ParsePE(const uint8_t* data, size_t size, ImageLayout& out) {
+        uint16_t magic = 0;
+        uint32_t lfanew = 0;
+        if (!ReadField(data, size, 0, magic) || magic != 0x5A4D) return false;
+        if (!ReadField(data, size, 0x3C, lfanew)) return false;
+
+        uint32_t signature = 0;
+        if (!ReadField(data, size, lfanew, signature) || signature != 0x00004550) return false;
+
+        const uint64_t fileHeader = (uint64_t)lfanew + 4;
+        uint16_t sectionCount = 0;
+        uint16_t optionalSize = 0;
+        if (!ReadField(data, size, fileHeader + 2, sectionCount)) return false;
+        if (!ReadField(data, size, fileHeader + 16, optionalSize)) return false;
+
+        const uint64_t optionalHeader = fileHeader + 20;
+        uint16_t optionalMagic = 0;
+        if (ReadField(data, size, optionalHeader, optionalMagic)) {
+            if (optionalMagic == 0x20B) {          // PE32+
+                ReadField(data, size, optionalHeader + 0x18, out.imageBase);
+            }
+            else if (optionalMagic == 0x10B) {     // PE32
+                uint32_t base32 = 0;
+                ReadField(data, size, optionalHeader + 0x1C, base32);
+                out.imageBase = base32;
+            }
+        }
+
+        const uint64_t table = optionalHeader + optionalSize;
+        for (uint16_t i = 0; i < sectionCount; i++) {
+            const uint64_t entry = table + (uint64_t)i * 40;
+            char name[9] = {0};
+            uint32_t virtualSize = 0, virtualAddress = 0, rawSize = 0, rawOffset = 0, characteristics = 0;
+            if (entry + 40 > size) return false;
+            memcpy(name, data + entry, 8);
+            ReadField(data, size, entry + 8, virtualSize);
+            ReadField(data, size, entry + 12, virtualAddress);
+            ReadField(data, size, entry + 16, rawSize);
+            ReadField(data, size, entry + 20, rawOffset);
+            ReadField(data, size, entry + 36, characteristics);
+
+            Section section;
+            section.name = name;
+            section.virtualAddress = virtualAddress;
+            section.virtualSize = virtualSize ? virtualSize : rawSize;
+            section.fileOffset = rawOffset;
+            section.fileSize = rawSize;
+            section.executable = (characteristics & 0x20000000) != 0;  // IMAGE_SCN_MEM_EXECUTE
+            section.writable = (characteristics & 0x80000000) != 0;    // IMAGE_SCN_MEM_WRITE
+            out.sections.push_back(section);
+        }
+
+        out.kind = ImageKind::PE;
+        return true;
+    }
+
+    // ====================================
+    // 第三部分：ELF 解析
+    // ====================================
+
+    /*
+     * ELF 结构速记（只处理小端）：
+     * e_ident[4] = 1(32位) / 2(64位)，e_ident[5] = 1(小端)
+     * 64 位：e_shoff @0x28, e_shentsize @0x3A, e_shnum @0x3C, e_shstrndx @0x3E
+     * 32 位：e_shoff @0x20, e_shentsize @0x2E, e_shnum @0x30, e_shstrndx @0x32
+     * 区段名保存在 e_shstrndx 指向的字符串表中
+     */
+    inline bool ParseELF(const uint8_t* data, size_t size, ImageLayout& out) {
+        if (size < 0x34 || memcmp(data, "\x7F" "ELF", 4) != 0) return false;
+        const bool is64 = data[4] == 2;
+        if (data[5] != 1) return false;  // 大端不支持
+
+        uint64_t shoff = 0;
+        uint16_t shentsize = 0, shnum = 0, shstrndx = 0;
+        if (is64) {
+            ReadField(data, size, 0x28, shoff);
+            ReadField(data, size, 0x3A, shentsize);
+            ReadField(data, size, 0x3C, shnum);
+            ReadField(data, size, 0x3E, shstrndx);
+        }
+        else {
+            uint32_t shoff32 = 0;
+            ReadField(data, size, 0x20, shoff32);
+            shoff = shoff32;
+            ReadField(data, size, 0x2E, shentsize);
+            ReadField(data, size, 0x30, shnum);
+            ReadField(data, size, 0x32, shstrndx);
+        }
+        if (shoff == 0 || shnum == 0 || shentsize < (is64 ? 64 : 40)) return false;
+
+        struct Raw {
+            uint32_t name = 0, type = 0;
+            uint64_t flags = 0, addr = 0, offset = 0, size = 0;
+        };
+        std::vector<Raw> raws(shnum);
+        for (uint16_t i = 0; i < shnum; i++) {
+            const uint64_t entry = shoff + (uint64_t)i * shentsize;
+            if (entry > size || shentsize > size - entry) return false;
+            Raw& r = raws[i];
+            ReadField(data, size, entry + 0, r.name);
+            ReadField(data, size, entry + 4, r.type);
+            if (is64) {
+                ReadField(data, size, entry + 8, r.flags);
+                ReadField(data, size, entry + 16, r.addr);
+                ReadField(data, size, entry + 24, r.offset);
+                ReadField(data, size, entry + 32, r.size);
+            }
+            else {
+                uint32_t v[5] = {0};
+                for (int k = 0; k < 5; k++) ReadField(data, size, entry + 8 + k * 4, v[k]);
+                r.flags = v[0];
+                r.addr = v[1];
+                r.offset = v[2];
+                r.size = v[3];
+            }
+        }
+
+        const Raw* strtab = shstrndx < shnum ? &raws[shstrndx] : nullptr;
+        for (uint16_t i = 1; i < shnum; i++) {  // 0 号区段固定为空
+            const Raw& r = raws[i];
+            Section section;
+            if (strtab && r.name < strtab->size && strtab->offset + r.name < size) {
+                const char* name = (const char*)data + strtab->offset + r.name;
+                size_t limit = (size_t)(size - (strtab->offset + r.name));
+                section.name.assign(name, strnlen(name, limit));
+            }
+            section.virtualAddress = r.addr;
+            section.virtualSize = r.size;
+            section.fileOffset = r.offset;
+            section.fileSize = r.type == 8 ? 0 : r.size;   // SHT_NOBITS（.bss）不占文件
+            section.executable = (r.flags & 0x4) != 0;     // SHF_EXECINSTR
+            section.writable = (r.flags & 0x1) != 0;       // SHF_WRITE
+            out.sections.push_back(section);
+        }
+
+        out.kind = ImageKind::ELF;
+        return true;
+    }
+
+    // 自动识别格式
+    inline bool ParseImage(const uint8_t* data, size_t size, ImageLayout& out) {
+        out = ImageLayout();
+        if (ParsePE(data, size, out)) return true;
+        out = ImageLayout();
+        return ParseELF(data, size, out);
+    }
+
+    // 把整个文件读进内存（离线分析磁盘上的 exe/so）
+    inline bool ReadWholeFile(const char* path, std::vector<uint8_t>& out) {
+        FILE* file = fopen(path, "rb");
+        if (!file) return false;
+        out.clear();
+        uint8_t buffer[64 * 1024];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            out.insert(out.end(), buffer, buffer + n);
+        }
+        fclose(file);
+        return true;
+    }
+
+    // ====================================
+    // 第四部分：区段 -> 扫描范围
+    // ====================================
+
+    struct ByteRange {
+        size_t offset = 0;   // 相对数据起点
+        size_t size = 0;
+    };
+
+    /*
+     * 区段声明写法：
+     * - ".text"            只扫 .text
+     * - ".text,.rdata"     多个区段用逗号分隔
+     * - "code"             所有可执行区段
+     * - "" 或 nullptr      整个数据（不过滤）
+     * 返回的范围按偏移升序、互不重叠
+     */
+    inline std::vector<ByteRange> SectionRanges(const ImageLayout& image, size_t dataSize, Layout layout, const char* sections) {
+        std::vector<ByteRange> ranges;
+        if (!sections || !*sections) {
+            ranges.push_back({0, dataSize});
+            return ranges;
+        }
+
+        std::vector<std::string> wanted;
+        std::string current;
+        for (const char* c = sections; ; c++) {
+            if (*c == ',' || *c == '\0') {
+                if (!current.empty()) wanted.push_back(current);
+                current.clear();
+                if (*c == '\0') break;
+            }
+            else if (*c != ' ') {
+                current += *c;
+            }
+        }
+
+        for (const auto& section : image.sections) {
+            bool selected = false;
+            for (const auto& name : wanted) {
+                if (name == section.name || (name == "code" && section.executable)) selected = true;
+            }
+            if (!selected) continue;
+
+            uint64_t begin = layout == Layout::File ? section.fileOffset : section.virtualAddress;
+            uint64_t length = layout == Layout::File ? section.fileSize : section.virtualSize;
+            if (length == 0 || begin >= dataSize) continue;
+            if (length > dataSize - begin) length = dataSize - begin;
+            ranges.push_back({(size_t)begin, (size_t)length});
+        }
+
+        // 排序并合并重叠范围，保证结果按地址升序且不重复
+        std::sort(ranges.begin(), ranges.end(), [](const ByteRange& a, const ByteRange& b) {
+            return a.offset < b.offset;
+        });
+        std::vector<ByteRange> merged;
+        for (const auto& r : ranges) {
+            if (!merged.empty() && r.offset <= merged.back().offset + merged.back().size) {
+                size_t end = r.offset + r.size;
+                size_t backEnd = merged.back().offset + merged.back().size;
+                if (end > backEnd) merged.back().size = end - merged.back().offset;
+            }
+            else {
+                merged.push_back(r);
+            }
+        }
+        return merged;
+    }
+
+    inline size_t TotalSize(const std::vector<ByteRange>& ranges) {
+        size_t total = 0;
+        for (const auto& r : ranges) total += r.size;
+        return total;
+    }
+}
+
+namespace PatternEngine {
+
+    // ====================================
+    // 第五部分：按区段扫描
+    // ====================================
+
+    // 单个特征码：只在指定区段内找第一个命中，返回相对 data 的偏移，找不到返回 SIZE_MAX
+    inline size_t FindFirstInSections(const uint8_t* data, size_t size, const ImageFormat::ImageLayout& image,
+                                      ImageFormat::Layout layout, const CompiledPattern& pattern, const char* sections) {
+        for (const auto& range : ImageFormat::SectionRanges(image, size, layout, sections)) {
+            const uint8_t* found = FindFirst(data + range.offset, range.size, pattern);
+            if (found) return (size_t)(found - data);
+        }
+        return SIZE_MAX;
+    }
+
+    /*
+     * 带区段声明的特征码集合
+     * 区段声明相同的特征码编进同一个自动机，每组只扫自己的区段
+     */
+    class SectionedSignatureSet {
+    public:
+        size_t Add(const CompiledPattern& pattern, const char* sections = ".text") {
+            std::string key = sections ? sections : "";
+            Group& group = groups[key];
+            group.members.push_back(count);
+            group.scanner.Add(pattern);
+            return count++;
+        }
+
+        size_t Add(const char* pattern, const char* sections = ".text") {
+            return Add(Compile(pattern), sections);
+        }
+
+        size_t Count() const { return count; }
+
+        // result[i] = 第 i 个特征码的全部命中偏移（升序）
+        std::vector<std::vector<size_t>> FindAll(const uint8_t* data, size_t size, const ImageFormat::ImageLayout& image,
+                                                 ImageFormat::Layout layout) {
+            std::vector<std::vector<size_t>> result(count);
+            scannedBytes = 0;
+            for (auto& entry : groups) {
+                Group& group = entry.second;
+                group.scanner.Build();
+                for (const auto& range : ImageFormat::SectionRanges(image, size, layout, entry.first.c_str())) {
+                    scannedBytes += range.size;
+                    group.scanner.ForEachMatch(data + range.offset, range.size, [&](size_t index, size_t offset) {
+                        result[group.members[index]].push_back(range.offset + offset);
+                        return true;
+                    });
+                }
+            }
+            return result;
+        }
+
+        // 最近一次 FindAll 实际扫描的字节数（用于对比整模块扫描）
+        size_t ScannedBytes() const { return scannedBytes; }
+
+    private:
+        struct Group {
+            MultiPatternScanner scanner;
+            std::vector<size_t> members;  // 组内编号 -> 全局编号
+        };
+
+        std::map<std::string, Group> groups;
+        size_t count = 0;
+        size_t scannedBytes = 0;
+    };
+}
@@ -0,0 +1,403 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：增量重扫（游戏更新后只扫变化的页）
+ * ========================================
+ *
+ * 游戏打一个小补丁，主程序里绝大多数页都没变，只是整体挪了位置。
+ * 思路：
+ * 1. 上次扫描时记下每一页（4KB）的哈希和每个特征码的命中
+ * 2. 新版本逐页算哈希，在旧哈希表里找"同内容的旧页"
+ * 3. 新旧页号连续对应的一段称为"干净段"：段内的旧命中平移后直接沿用
+ * 4. 只有变化的页、以及干净段边界附近（特征码长度范围内）的位置需要重扫
+ * 5. 最后给出报告：哪些特征码挪了位置、哪些丢了
+ *
+ * 定义 INCREMENTAL_SCAN_VERIFY 时，每次增量扫描后再全量扫一遍比对，
+ * 只把不一致的特征码数记在报告里，返回的仍是增量结果（慢，只用来核对增量逻辑）。
+ */
+
+#pragma once
+#include "PatternScan.h"
+#include "MultiPatternScan.h"
+#include "FastHash.h"
+#include "ScanCache.h"
+#include <algorithm>
+#include <unordered_map>
+#include <cstdio>
+
+namespace PatternEngine {
+
+    // 上一次扫描留下的状态（可以存盘，下次更新时再用）
+    struct IncrementalScanState {
+        static constexpr uint32_t DefaultPageSize = 4096;
+        static constexpr uint32_t Version = 2;
+
+        uint64_t signatureHash = 0;              // 扫描时用的特征码集合（改了/换了顺序，旧命中就不能沿用）
+        uint32_t pageSize = DefaultPageSize;
+        uint64_t imageSize = 0;
+        std::vector<uint64_t> pageHashes;
+        std::vector<std::vector<size_t>> hits;   // hits[特征码] = 命中偏移（升序）
+
+        bool Empty() const { return pageHashes.empty(); }
+
+        /*
+         * 文件格式（小端）：
+         *   "INCS" | version u32 | signatureHash u64
+         *   | pageSize u32 | imageSize u64 | pageCount u32 | pageHashes u64[]
+         *   | patternCount u32 | 每个特征码：hitCount u32 | offsets u64[]
+         */
+        bool Save(const char* path) const {
+            FILE* file = fopen(path, "wb");
+            if (!file) return false;
+            uint32_t pageCount = (uint32_t)pageHashes.size();
+            uint32_t patternCount = (uint32_t)hits.size();
+            bool ok = fwrite("INCS", 1, 4, file) == 4
+                   && fwrite(&Version, sizeof(Version), 1, file) == 1
+                   && fwrite(&signatureHash, sizeof(signatureHash), 1, file) == 1
+                   && fwrite(&pageSize, sizeof(pageSize), 1, file) == 1
+                   && fwrite(&imageSize, sizeof(imageSize), 1, file) == 1
+                   && fwrite(&pageCount, sizeof(pageCount), 1, file) == 1
+                   && (pageCount == 0 || fwrite(pageHashes.data(), sizeof(uint64_t), pageCount, file) == pageCount)
+                   && fwrite(&patternCount, sizeof(patternCount), 1, file) == 1;
+            for (const auto& list : hits) {
+                if (!ok) break;
+                uint32_t count = (uint32_t)list.size();
+                ok = fwrite(&count, sizeof(count), 1, file) == 1;
+                for (size_t offset : list) {
+                    uint64_t value = offset;
+                    ok = ok && fwrite(&value, sizeof(value), 1, file) == 1;
+                }
+            }
+            return (fclose(file) == 0) && ok;
+        }
+
+        bool Load(const char* path) {
+            FILE* file = fopen(path, "rb");
+            if (!file) return false;
+
+            // 各个数量都来自文件：分配前先和剩下的字节数比一下，损坏的文件直接判失败
+            long fileSize = -1;
+            if (fseek(file, 0, SEEK_END) == 0) fileSize = ftell(file);
+            if (fileSize < 0 || fseek(file, 0, SEEK_SET) != 0) {
+                fclose(file);
+                return false;
+            }
+            auto fits = [&](uint64_t count, uint64_t itemSize) {
+                long position = ftell(file);
+                return position >= 0 && count <= (uint64_t)(fileSize - position) / itemSize;
+            };
+
+            char magic[4];
+            uint32_t version = 0, pageCount = 0, patternCount = 0;
+            bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, "INCS", 4) == 0
+                   && fread(&version, sizeof(version), 1, file) == 1 && version == Version
+                   && fread(&signatureHash, sizeof(signatureHash), 1, file) == 1
+                   && fread(&pageSize, sizeof(pageSize), 1, file) == 1 && pageSize > 0
+                   && fread(&imageSize, sizeof(imageSize), 1, file) == 1
+                   && fread(&pageCount, sizeof(pageCount), 1, file) == 1
+                   && pageCount == imageSize / pageSize + (imageSize % pageSize != 0)
+                   && fits(pageCount, sizeof(uint64_t));
+            if (ok) {
+                pageHashes.resize(pageCount);
+                ok = pageCount == 0 || fread(pageHashes.data(), sizeof(uint64_t), pageCount, file) == pageCount;
+            }
+            ok = ok && fread(&patternCount, sizeof(patternCount), 1, file) == 1
+                    && fits(patternCount, sizeof(uint32_t));     // 每个特征码至少有一个 hitCount
+            if (ok) hits.assign(patternCount, {});
+            for (uint32_t k = 0; ok && k < patternCount; k++) {
+                uint32_t count = 0;
+                ok = fread(&count, sizeof(count), 1, file) == 1 && fits(count, sizeof(uint64_t));
+                if (ok) hits[k].reserve(count);
+                for (uint32_t i = 0; ok && i < count; i++) {
+                    uint64_t value = 0;
+                    ok = fread(&value, sizeof(value), 1, file) == 1;
+                    hits[k].push_back((size_t)value);
+                }
+            }
+            fclose(file);
+            if (!ok) *this = IncrementalScanState();
+            return ok;
+        }
+    };
+
+    // 单个特征码的变化
+    struct SignatureChange {
+        enum class Kind {
+            Unchanged,   // 第一个命中位置没变
+            Moved,       // 还能找到，但位置变了
+            Lost,        // 新版本里找不到了
+            Found        // 旧版本没有，新版本有
+        };
+
+        size_t index = 0;
+        Kind kind = Kind::Unchanged;
+        size_t oldOffset = SIZE_MAX;   // 第一个命中（SIZE_MAX 表示没有）
+        size_t newOffset = SIZE_MAX;
+        size_t oldHitCount = 0;
+        size_t newHitCount = 0;
+    };
+
+    struct IncrementalReport {
+        size_t totalPages = 0;
+        size_t reusedPages = 0;        // 在旧版本中找到同内容页的数量
+        size_t rescannedBytes = 0;     // 实际重扫的字节数
+        bool fullScan = false;         // 没有旧状态时退化为全量扫描
+        size_t verifyMismatches = 0;   // INCREMENTAL_SCAN_VERIFY：增量结果和全量扫描不同的特征码数
+        std::vector<SignatureChange> changes;
+
+        size_t MovedCount() const {
+            size_t n = 0;
+            for (const auto& c : changes) {
+                if (c.kind != SignatureChange::Kind::Unchanged) n++;
+            }
+            return n;
+        }
+
+        void Print() const {
+            printf("页数: %zu  复用: %zu  重扫字节: %zu%s\n",
+                   totalPages, reusedPages, rescannedBytes, fullScan ? "（全量扫描）" : "");
+            if (verifyMismatches) printf("  比对全量扫描：%zu 个特征码不一致（增量逻辑有问题）\n", verifyMismatches);
+            for (const auto& c : changes) {
+                if (c.kind == SignatureChange::Kind::Unchanged) continue;
+                const char* kind = c.kind == SignatureChange::Kind::Moved ? "移动"
+                                 : c.kind == SignatureChange::Kind::Lost ? "丢失" : "新增";
+                printf("  特征码[%zu] %s: 0x%zx -> 0x%zx (命中 %zu -> %zu)\n", c.index, kind,
+                       c.oldOffset == SIZE_MAX ? (size_t)0 : c.oldOffset,
+                       c.newOffset == SIZE_MAX ? (size_t)0 : c.newOffset,
+                       c.oldHitCount, c.newHitCount);
+            }
+        }
+    };
+
+    class IncrementalScanner {
+    public:
+        explicit IncrementalScanner(const MultiPatternScanner& signatures) : scanner(signatures) {
+            for (size_t k = 0; k < scanner.PatternCount(); k++) {
+                uint64_t key = ScanCache::PatternKey(scanner.GetPattern(k));
+                signatureHash = FastHash::XXH64(&key, sizeof(key), signatureHash);
+            }
+        }
+
+        // 计算整个镜像的页哈希表
+        static std::vector<uint64_t> HashPages(const uint8_t* data, size_t size, uint32_t pageSize) {
+            std::vector<uint64_t> hashes((size + pageSize - 1) / pageSize);
+            for (size_t i = 0; i < hashes.size(); i++) {
+                size_t begin = i * pageSize;
+                size_t length = size - begin < pageSize ? size - begin : pageSize;
+                hashes[i] = FastHash::XXH64(data + begin, length);
+            }
+            return hashes;
+        }
+
+        /*
+         * 扫描新镜像：
+         * - previous 为空：全量扫描
+         * - 否则只重扫变化的部分
+         * 返回新的状态（下次更新时作为 previous），report 记录变化
+         */
+        IncrementalScanState Scan(const uint8_t* data, size_t size, const IncrementalScanState& previous,
+                                  IncrementalReport* report = nullptr) const {
+            IncrementalScanState next;
+            next.signatureHash = signatureHash;
+            next.pageSize = previous.Empty() ? IncrementalScanState::DefaultPageSize : previous.pageSize;
+            next.imageSize = size;
+            next.pageHashes = HashPages(data, size, next.pageSize);
+            next.hits.assign(scanner.PatternCount(), {});
+
+            IncrementalReport localReport;
+            IncrementalReport& r = report ? *report : localReport;
+            r = IncrementalReport();
+            r.totalPages = next.pageHashes.size();
+
+            // 特征码集合变了（改了某一条或者换了顺序）：旧命中对不上号，全量扫描
+            const bool usable = !previous.Empty() && previous.signatureHash == signatureHash
+                             && previous.hits.size() == scanner.PatternCount();
+            if (!usable) {
+                r.fullScan = true;
+                r.rescannedBytes = size;
+                next.hits = scanner.FindAll(data, size);
+                // 特征码集合不同时旧命中和新特征码对不上号，不拿来比较
+                BuildChanges(previous.signatureHash == signatureHash ? previous : IncrementalScanState(), next, r);
+                return next;
+            }
+
+            const uint32_t P = next.pageSize;
+            std::vector<Run> runs = MatchPages(previous, next, size, r);
+
+            // 页号 -> 所属干净段（-1 表示变化页）
+            std::vector<int32_t> runOfPage(next.pageHashes.size(), -1);
+            for (size_t k = 0; k < runs.size(); k++) {
+                for (size_t p = runs[k].newPage; p < runs[k].newPage + runs[k].pageCount; p++) {
+                    runOfPage[p] = (int32_t)k;
+                }
+            }
+
+            // 起点 start、长度 length 的窗口是否完全落在某个干净段内
+            auto insideRun = [&](size_t start, size_t length) {
+                if (length == 0) return false;
+                int32_t a = runOfPage[start / P];
+                if (a < 0) return false;
+                size_t last = start + length - 1;
+                return last < runs[a].newEnd && runOfPage[last / P] == a;
+            };
+
+            // 1. 沿用旧命中：窗口完全在干净段内的命中平移到新位置
+            for (size_t k = 0; k < scanner.PatternCount(); k++) {
+                const size_t length = scanner.GetPattern(k).Size();
+                if (length == 0) {
+                    next.hits[k].push_back(0);  // 空特征码只在 0 处命中，与 FindAll 一致
+                    continue;
+                }
+                const auto& oldHits = previous.hits[k];
+                for (const Run& run : runs) {
+                    size_t runBytes = run.newEnd - run.newBegin;
+                    if (runBytes < length) continue;
+                    size_t oldLimit = run.oldBegin + runBytes - length;  // 最后一个完整落在段内的起点
+                    auto it = std::lower_bound(oldHits.begin(), oldHits.end(), run.oldBegin);
+                    for (; it != oldHits.end() && *it <= oldLimit; ++it) {
+                        next.hits[k].push_back(*it - run.oldBegin + run.newBegin);
+                    }
+                }
+            }
+
+            // 2. 重扫：所有"不完全在干净段内"的起点
+            size_t longest = 1;
+            for (size_t k = 0; k < scanner.PatternCount(); k++) {
+                if (scanner.GetPattern(k).Size() > longest) longest = scanner.GetPattern(k).Size();
+            }
+            for (const auto& interval : RescanIntervals(runs, size, longest)) {
+                size_t windowEnd = interval.second + longest - 1;
+                if (windowEnd > size) windowEnd = size;
+                size_t window = windowEnd - interval.first;
+                r.rescannedBytes += window;
+                scanner.ForEachMatch(data + interval.first, window, [&](size_t index, size_t offset) {
+                    size_t start = interval.first + offset;
+                    if (start >= interval.second) return true;              // 属于下一个区间
+                    const size_t length = scanner.GetPattern(index).Size();
+                    if (length == 0) return true;                           // 已在上面处理
+                    if (insideRun(start, length)) return true;              // 已由旧命中覆盖
+                    next.hits[index].push_back(start);
+                    return true;
+                });
+            }
+
+            for (auto& list : next.hits) {
+                std::sort(list.begin(), list.end());
+                list.erase(std::unique(list.begin(), list.end()), list.end());
+            }
+
+#if defined(INCREMENTAL_SCAN_VERIFY)
+            std::vector<std::vector<size_t>> full = scanner.FindAll(data, size);
+            for (size_t k = 0; k < full.size(); k++) {
+                if (full[k] != next.hits[k]) r.verifyMismatches++;
+            }
+#endif
+            BuildChanges(previous, next, r);
+            return next;
+        }
+
+    private:
+        // 干净段：新页 [newPage, newPage + pageCount) 与旧页 [oldPage, ...) 内容一一相同
+        struct Run {
+            size_t newPage = 0;
+            size_t oldPage = 0;
+            size_t pageCount = 0;
+            size_t newBegin = 0;  // 段的字节范围 [newBegin, newEnd)，最后一页可能不满
+            size_t newEnd = 0;
+            size_t oldBegin = 0;
+        };
+
+        static std::vector<Run> MatchPages(const IncrementalScanState& previous, const IncrementalScanState& next,
+                                           size_t size, IncrementalReport& r) {
+            // 旧页哈希 -> 第一个旧页号（重复内容的页，例如全零页，只记第一个）
+            std::unordered_map<uint64_t, size_t> oldIndex;
+            oldIndex.reserve(previous.pageHashes.size());
+            for (size_t i = 0; i < previous.pageHashes.size(); i++) {
+                oldIndex.emplace(previous.pageHashes[i], i);
+            }
+
+            const size_t P = next.pageSize;
+            std::vector<Run> runs;
+            for (size_t p = 0; p < next.pageHashes.size(); p++) {
+                const uint64_t h = next.pageHashes[p];
+                size_t oldPage = SIZE_MAX;
+
+                // 优先延续上一段（处理重复页时保持连续）
+                if (!runs.empty() && runs.back().newPage + runs.back().pageCount == p) {
+                    size_t candidate = runs.back().oldPage + runs.back().pageCount;
+                    if (candidate < previous.pageHashes.size() && previous.pageHashes[candidate] == h) {
+                        runs.back().pageCount++;
+                        runs.back().newEnd = (p + 1) * P < size ? (p + 1) * P : size;
+                        r.reusedPages++;
+                        continue;
+                    }
+                }
+                if (p < previous.pageHashes.size() && previous.pageHashes[p] == h) {
+                    oldPage = p;  // 同一位置没变
+                }
+                else {
+                    auto it = oldIndex.find(h);
+                    if (it != oldIndex.end()) oldPage = it->second;
+                }
+                if (oldPage == SIZE_MAX) continue;
+
+                // 最后一个旧页可能不满一页：只有长度也一致时哈希才会相同
+                Run run;
+                run.newPage = p;
+                run.oldPage = oldPage;
+                run.pageCount = 1;
+                run.newBegin = p * P;
+                run.oldBegin = oldPage * P;
+                run.newEnd = (p + 1) * P < size ? (p + 1) * P : size;
+                runs.push_back(run);
+                r.reusedPages++;
+            }
+            return runs;
+        }
+
+        // 需要重扫的起点区间 [begin, end)：变化页 + 每个干净段末尾 (longest - 1) 字节
+        // 段内 [newBegin, newEnd - margin) 的起点窗口完全落在段内，由旧命中覆盖
+        static std::vector<std::pair<size_t, size_t>> RescanIntervals(const std::vector<Run>& runs, size_t size, size_t longest) {
+            std::vector<std::pair<size_t, size_t>> intervals;
+            const size_t margin = longest - 1;
+            size_t cursor = 0;
+            for (const Run& run : runs) {
+                const size_t safeEnd = run.newEnd - run.newBegin > margin ? run.newEnd - margin : run.newBegin;
+                if (run.newBegin > cursor) {
+                    if (!intervals.empty() && intervals.back().second == cursor) {
+                        intervals.back().second = run.newBegin;
+                    }
+                    else {
+                        intervals.push_back({cursor, run.newBegin});
+                    }
+                }
+                cursor = safeEnd > run.newBegin ? safeEnd : run.newBegin;
+            }
+            if (cursor < size) intervals.push_back({cursor, size});
+            return intervals;
+        }
+
+        static void BuildChanges(const IncrementalScanState& previous, const IncrementalScanState& next, IncrementalReport& r) {
+            for (size_t k = 0; k < next.hits.size(); k++) {
+                SignatureChange c;
+                c.index = k;
+                if (k < previous.hits.size() && !previous.hits[k].empty()) {
+                    c.oldOffset = previous.hits[k][0];
+                    c.oldHitCount = previous.hits[k].size();
+                }
+                if (!next.hits[k].empty()) {
+                    c.newOffset = next.hits[k][0];
+                    c.newHitCount = next.hits[k].size();
+                }
+                if (c.oldOffset == SIZE_MAX && c.newOffset == SIZE_MAX) c.kind = SignatureChange::Kind::Unchanged;
+                else if (c.newOffset == SIZE_MAX) c.kind = SignatureChange::Kind::Lost;
+                else if (c.oldOffset == SIZE_MAX) c.kind = SignatureChange::Kind::Found;
+                else if (c.oldOffset == c.newOffset) c.kind = SignatureChange::Kind::Unchanged;
+                else c.kind = SignatureChange::Kind::Moved;
+                r.changes.push_back(c);
+            }
+        }
+
+        const MultiPatternScanner& scanner;
+        uint64_t signatureHash = 0;
+    };
+}
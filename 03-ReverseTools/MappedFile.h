@@ -0,0 +1,235 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：离线扫描（内存映射文件）
+ * ========================================
+ *
+ * 不是每次都要附加到游戏进程：
+ * 归档的旧版本 exe、内存 dump 文件都可以直接在磁盘上扫描。
+ *
+ * 做法：把文件只读映射到内存（Linux: mmap / Windows: MapViewOfFile），
+ * 映射出来的指针直接交给 PatternEngine，不拷贝任何数据。
+ * 顺序扫描时告诉内核"我要从头读到尾"（madvise SEQUENTIAL），预读更积极。
+ */
+
+#pragma once
+#include "PatternScan.h"
+#include "ParallelScan.h"
+#include "ImageSections.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ====================================
+// 第一部分：只读映射文件
+// ====================================
+
+class MappedFile {
+public:
+    // 访问模式提示
+    enum class AccessHint {
+        Normal,
+        Sequential,   // 从头扫到尾（特征码扫描）
+        Random        // 随机访问（指针链、查表）
+    };
+
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { *this = static_cast<MappedFile&&>(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Close();
+            data = other.data;
+            size = other.size;
+            open = other.open;
+#ifdef _WIN32
+            fileHandle = other.fileHandle;
+            mappingHandle = other.mappingHandle;
+            other.fileHandle = INVALID_HANDLE_VALUE;
+            other.mappingHandle = nullptr;
+#endif
+            other.data = nullptr;
+            other.size = 0;
+            other.open = false;
+        }
+        return *this;
+    }
+
+    bool Open(const char* path, AccessHint hint = AccessHint::Sequential) {
+        Close();
+#ifdef _WIN32
+        DWORD flags = hint == AccessHint::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN
+                    : hint == AccessHint::Random ? FILE_FLAG_RANDOM_ACCESS
+                    : FILE_ATTRIBUTE_NORMAL;
+        fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize)) {
+            Close();
+            return false;
+        }
+        size = (size_t)fileSize.QuadPart;
+        open = true;
+        if (size == 0) return true;  // 空文件无法映射，但视为打开成功
+
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle) {
+            Close();
+            return false;
+        }
+        data = (const uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (!data) {
+            Close();
+            return false;
+        }
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = (size_t)st.st_size;
+        open = true;
+        if (size == 0) {
+            ::close(fd);
+            return true;
+        }
+
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // 映射建立后文件描述符就可以关掉了
+        if (mapped == MAP_FAILED) {
+            size = 0;
+            open = false;
+            return false;
+        }
+        data = (const uint8_t*)mapped;
+        Advise(hint);
+#endif
+        return true;
+    }
+
+    // 调整访问提示（例如先顺序扫描，再随机解析指针）
+    void Advise(AccessHint hint) {
+#ifndef _WIN32
+        if (!data) return;
+        int advice = hint == AccessHint::Sequential ? MADV_SEQUENTIAL
+                   : hint == AccessHint::Random ? MADV_RANDOM
+                   : MADV_NORMAL;
+        madvise((void*)data, size, advice);
+#else
+        (void)hint;
+#endif
+    }
+
+    void Close() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap((void*)data, size);
+#endif
+        data = nullptr;
+        size = 0;
+        open = false;
+    }
+
+    const uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+    bool IsOpen() const { return open; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    bool open = false;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#endif
+};
+
+// ====================================
+// 第二部分：离线镜像扫描
+// ====================================
+
+/*
+ * 磁盘上的 exe/so/dump：
+ * - 能识别出 PE/ELF 时，按区段扫描（文件布局）
+ * - 识别不出（例如原始内存 dump）时，整个文件当作一段数据扫描
+ * 返回的都是文件偏移
+ */
+class OfflineImage {
+public:
+    bool Open(const char* path) {
+        image = ImageFormat::ImageLayout();
+        if (!file.Open(path, MappedFile::AccessHint::Sequential)) return false;
+        if (file.Size() > 0) ImageFormat::ParseImage(file.Data(), file.Size(), image);
+        return true;
+    }
+
+    const MappedFile& File() const { return file; }
+    const ImageFormat::ImageLayout& Image() const { return image; }
+    bool HasSections() const { return image.kind != ImageFormat::ImageKind::Unknown; }
+
+    // 第一个命中的文件偏移，找不到返回 SIZE_MAX
+    // sections 为 nullptr 或没有区段表时扫描整个文件
+    size_t FindFirst(const PatternEngine::CompiledPattern& pattern, const char* sections = nullptr) const {
+        if (!file.Data()) return SIZE_MAX;
+        if (sections && HasSections()) {
+            return PatternEngine::FindFirstInSections(file.Data(), file.Size(), image,
+                                                      ImageFormat::Layout::File, pattern, sections);
+        }
+        const uint8_t* found = PatternEngine::ParallelFindFirst(file.Data(), file.Size(), pattern);
+        return found ? (size_t)(found - file.Data()) : SIZE_MAX;
+    }
+
+    // 全部命中的文件偏移（升序）
+    std::vector<size_t> FindAll(const PatternEngine::CompiledPattern& pattern, const char* sections = nullptr) const {
+        std::vector<size_t> hits;
+        if (!file.Data()) return hits;
+        if (sections && HasSections()) {
+            for (const auto& range : ImageFormat::SectionRanges(image, file.Size(), ImageFormat::Layout::File, sections)) {
+                for (size_t offset : PatternEngine::FindAll(file.Data() + range.offset, range.size, pattern)) {
+                    hits.push_back(range.offset + offset);
+                }
+            }
+            return hits;
+        }
+        return PatternEngine::ParallelFindAll(file.Data(), file.Size(), pattern);
+    }
+
+    // 多个带区段声明的特征码
+    std::vector<std::vector<size_t>> FindAll(PatternEngine::SectionedSignatureSet& signatures) const {
+        if (!file.Data()) return std::vector<std::vector<size_t>>(signatures.Count());
+        return signatures.FindAll(file.Data(), file.Size(), image, ImageFormat::Layout::File);
+    }
+
+    // 文件偏移 -> 加载后的 RVA（用于和 x64dbg/IDA 中的地址对照）
+    uint64_t FileOffsetToRva(size_t offset) const {
+        for (const auto& section : image.sections) {
+            if (section.fileSize && offset >= section.fileOffset && offset < section.fileOffset + section.fileSize) {
+                return section.virtualAddress + (offset - section.fileOffset);
+            }
+        }
+        return offset;
+    }
+
+private:
+    MappedFile file;
+    ImageFormat::ImageLayout image;
+};
@@ -0,0 +1,230 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：多特征码单次扫描
+ * ========================================
+ *
+ * 更新偏移时往往要同时定位几十个特征码（GEngine、GWorld、GNames...）。
+ * 逐个调用 ScanPattern 需要把整个模块扫几十遍，
+ * 这里把所有特征码编译成一个 Aho-Corasick 自动机，只扫一遍。
+ *
+ * 通配符怎么处理？
+ * - 每个特征码取"最长的一段连续具体字节"作为关键字放进自动机
+ * - 自动机命中关键字后，回退到特征码起点，用 value/mask 校验整条特征码
+ * - 纯通配符的特征码没有关键字，单独处理
+ */
+
+#pragma once
+#include "PatternScan.h"
+#include <array>
+#include <queue>
+
+namespace PatternEngine {
+
+    class MultiPatternScanner {
+    public:
+        // 关键字最长取多少字节（越长误报越少，但自动机状态越多）
+        static constexpr size_t MaxKeywordLength = 16;
+
+        MultiPatternScanner() = default;
+
+        explicit MultiPatternScanner(const std::vector<CompiledPattern>& patterns) {
+            for (const auto& p : patterns) Add(p);
+            Build();
+        }
+
+        // 添加特征码，返回它的编号（即结果数组中的下标）
+        size_t Add(const CompiledPattern& pattern) {
+            patterns.push_back(pattern);
+            built = false;
+            return patterns.size() - 1;
+        }
+
+        size_t Add(const char* pattern) {
+            return Add(Compile(pattern));
+        }
+
+        size_t PatternCount() const { return patterns.size(); }
+        size_t StateCount() const { return transitions.size(); }
+        const CompiledPattern& GetPattern(size_t index) const { return patterns[index]; }
+
+        // 编译自动机（Add 之后、扫描之前调用一次）
+        void Build() {
+            transitions.clear();
+            outputs.clear();
+            keywords.clear();
+            wildcardOnly.clear();
+            NewState();
+
+            // 1. 选关键字并插入 Trie
+            std::vector<std::vector<uint32_t>> ownOutputs(1);
+            for (size_t i = 0; i < patterns.size(); i++) {
+                if (patterns[i].overflow) continue;     // 被截断的特征码不参与匹配
+                Keyword kw = PickKeyword(patterns[i]);
+                kw.pattern = i;
+                if (kw.length == 0) {
+                    wildcardOnly.push_back(i);
+                    continue;
+                }
+
+                int32_t state = 0;
+                for (size_t j = 0; j < kw.length; j++) {
+                    uint8_t c = patterns[i].value[kw.offset + j];
+                    if (transitions[state][c] < 0) {
+                        transitions[state][c] = NewState();
+                        ownOutputs.emplace_back();
+                    }
+                    state = transitions[state][c];
+                }
+                ownOutputs[state].push_back((uint32_t)keywords.size());
+                keywords.push_back(kw);
+            }
+
+            // 2. BFS 计算失败指针，同时把 Trie 补全成 DFA（每个字节一次查表）
+            std::vector<int32_t> fail(transitions.size(), 0);
+            std::vector<std::vector<uint32_t>> allOutputs = ownOutputs;
+            std::queue<int32_t> queue;
+            for (int c = 0; c < 256; c++) {
+                int32_t next = transitions[0][c];
+                if (next < 0) {
+                    transitions[0][c] = 0;
+                }
+                else {
+                    fail[next] = 0;
+                    queue.push(next);
+                }
+            }
+            while (!queue.empty()) {
+                int32_t state = queue.front();
+                queue.pop();
+                // 输出 = 自己的关键字 + 失败链上的关键字（失败状态更浅，已处理完）
+                const auto& inherited = allOutputs[fail[state]];
+                allOutputs[state].insert(allOutputs[state].end(), inherited.begin(), inherited.end());
+
+                for (int c = 0; c < 256; c++) {
+                    int32_t next = transitions[state][c];
+                    if (next < 0) {
+                        transitions[state][c] = transitions[fail[state]][c];
+                    }
+                    else {
+                        fail[next] = transitions[fail[state]][c];
+                        queue.push(next);
+                    }
+                }
+            }
+
+            // 3. 输出表压平：outputStart[s] .. outputStart[s+1]
+            outputStart.assign(transitions.size() + 1, 0);
+            for (size_t s = 0; s < transitions.size(); s++) {
+                outputStart[s + 1] = outputStart[s] + (uint32_t)allOutputs[s].size();
+            }
+            outputs.reserve(outputStart.back());
+            for (const auto& list : allOutputs) {
+                outputs.insert(outputs.end(), list.begin(), list.end());
+            }
+
+            built = true;
+        }
+
+        /*
+         * 单次遍历，onHit(patternIndex, offset) 返回 false 时提前结束
+         * 同一个特征码的命中按地址从低到高给出
+         */
+        template<typename OnHit>
+        void ForEachMatch(const uint8_t* data, size_t size, OnHit onHit) const {
+            if (!built) return;
+
+            // 纯通配符特征码：任意位置都匹配
+            for (size_t index : wildcardOnly) {
+                bool keepGoing = true;
+                PatternEngine::ForEachMatch(data, size, patterns[index], [&](size_t offset) {
+                    keepGoing = onHit(index, offset);
+                    return keepGoing;
+                });
+                if (!keepGoing) return;
+            }
+
+            int32_t state = 0;
+            for (size_t pos = 0; pos < size; pos++) {
+                state = transitions[state][data[pos]];
+                uint32_t begin = outputStart[state];
+                uint32_t end = outputStart[state + 1];
+                for (uint32_t k = begin; k < end; k++) {
+                    const Keyword& kw = keywords[outputs[k]];
+                    const CompiledPattern& p = patterns[kw.pattern];
+
+                    // 关键字结束于 pos，回推特征码起点
+                    size_t back = kw.offset + kw.length - 1;
+                    if (pos < back) continue;
+                    size_t start = pos - back;
+                    if (start + p.Size() > size) continue;
+
+                    if (MatchAt(data + start, p) && !onHit(kw.pattern, start)) return;
+                }
+            }
+        }
+
+        // 返回每个特征码的全部命中偏移：result[patternIndex] = {offset...}
+        std::vector<std::vector<size_t>> FindAll(const uint8_t* data, size_t size) const {
+            std::vector<std::vector<size_t>> result(patterns.size());
+            ForEachMatch(data, size, [&](size_t index, size_t offset) {
+                result[index].push_back(offset);
+                return true;
+            });
+            return result;
+        }
+
+        // 返回每个特征码的第一个命中地址，找不到为 nullptr
+        // 所有特征码都找到后提前结束
+        std::vector<const uint8_t*> FindFirst(const uint8_t* data, size_t size) const {
+            std::vector<const uint8_t*> result(patterns.size(), nullptr);
+            size_t remaining = patterns.size();
+            ForEachMatch(data, size, [&](size_t index, size_t offset) {
+                if (!result[index]) {
+                    result[index] = data + offset;
+                    remaining--;
+                }
+                return remaining > 0;
+            });
+            return result;
+        }
+
+    private:
+        struct Keyword {
+            size_t pattern = 0;   // 所属特征码
+            size_t offset = 0;    // 关键字在特征码中的起始位置
+            size_t length = 0;    // 关键字长度（0 表示纯通配符）
+        };
+
+        // 取最长的连续具体字节段作为关键字
+        static Keyword PickKeyword(const CompiledPattern& p) {
+            Keyword best;
+            size_t runStart = 0;
+            for (size_t i = 0; i <= p.Size(); i++) {
+                if (i < p.Size() && p.mask[i] == 0xFF) continue;
+                size_t runLength = i - runStart;
+                if (runLength > best.length) {
+                    best.offset = runStart;
+                    best.length = runLength;
+                }
+                runStart = i + 1;
+            }
+            if (best.length > MaxKeywordLength) best.length = MaxKeywordLength;
+            return best;
+        }
+
+        int32_t NewState() {
+            std::array<int32_t, 256> row;
+            row.fill(-1);
+            transitions.push_back(row);
+            return (int32_t)transitions.size() - 1;
+        }
+
+        std::vector<CompiledPattern> patterns;
+        std::vector<Keyword> keywords;
+        std::vector<size_t> wildcardOnly;
+        std::vector<std::array<int32_t, 256>> transitions;  // DFA 跳转表
+        std::vector<uint32_t> outputStart;                  // 每个状态的输出区间
+        std::vector<uint32_t> outputs;                      // 关键字编号
+        bool built = false;
+    };
+}
@@ -0,0 +1,261 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：GNames 离线解码缓存
+ * ========================================
+ *
+ * dump 对象时每个对象都要解析 NamePrivate：
+ *   Blocks[Index >> 16] -> 块内偏移 -> 读 2 字节头 -> 判断宽/窄字符 -> 取长度 -> 拷字符
+ * 几十万个对象、每个对象再加上类名和 Outer 链，同样的解码要做几百万次。
+ *
+ * 这里把整个 GNames（FNamePool 的所有块）一次解码完：
+ * 1. 每个块一个任务并行：先数出条目数和解码后的字节数
+ * 2. 前缀和算出每个块在 arena 里的起点
+ * 3. 再并行一遍：字符串写进同一块 arena（宽字符转成 UTF-8），
+ *    同时填 Index -> (arena 偏移, 长度) 的平铺表
+ * 4. 建一张 名字 -> Index 的反向哈希表
+ * 之后 GetName(Index) 就是一次数组加载，Find("PlayerController") 是一次哈希探测。
+ *
+ * 块格式与 02-UEObjectSystem/NamePool.h 相同（UE4.23+）：
+ *   Index = 块号 << 16 | 块内偏移 / 2
+ *   条目 = 2 字节头（长度 << 6 | 探测哈希 << 1 | bIsWide）+ 字符，按 2 字节对齐
+ *   头为 0（长度 0）表示块内后面没有条目了
+ *   块号只有 13 位，最多 MaxBlocks = 8192 块（1GB），超过的输入直接拒绝
+ *
+ * 平铺表按 2 字节一个槽位，每槽 8 字节，内存约为 dump 大小的 4 倍。
+ */
+
+#pragma once
+#include "FastHash.h"
+#include "MappedFile.h"
+#include "ParallelScan.h"
+#include "ScatterRead.h"
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+class NameCache {
+public:
+    static constexpr uint32_t Stride = 2;
+    static constexpr uint32_t BlockOffsetBits = 16;
+    static constexpr uint32_t BlockBytes = Stride << BlockOffsetBits;      // 128KB
+    static constexpr uint32_t MaxBlocks = 8192;                             // 块号 13 位，与 NamePool.h 相同
+    static constexpr uint32_t InvalidId = 0xFFFFFFFF;
+
+    /*
+     * 从块指针解码（blocks[i] 指向第 i 块，sizes[i] 是它的有效字节数，不超过 BlockBytes）
+     * threads 为 0 时使用全部核心
+     */
+    bool Build(const uint8_t* const* blocks, const size_t* sizes, uint32_t blockCount, unsigned threads = 0) {
+        Clear();
+        if (blockCount == 0 || blockCount > MaxBlocks) return false;
+
+        // 1. 每块统计：条目数、解码后的字节数
+        std::vector<BlockInfo> info(blockCount);
+        PatternEngine::ChunkStealingPool::Run(blockCount, threads, [&](size_t b) {
+            BlockInfo& block = info[b];
+            Walk(blocks[b], sizes[b], [&block](uint32_t, const uint8_t* chars, uint32_t length, bool wide) {
+                block.names++;
+                block.bytes += wide ? Utf8Length(chars, length) : length;
+            });
+        });
+
+        // 2. 前缀和
+        uint64_t total = 0;
+        for (BlockInfo& block : info) {
+            block.arenaOffset = total;
+            total += block.bytes;
+            nameCount += block.names;
+        }
+        arena.resize((size_t)total);
+        table.assign((size_t)blockCount << BlockOffsetBits, 0);
+
+        // 3. 写 arena 和平铺表（各块写各自的区间，互不重叠）
+        PatternEngine::ChunkStealingPool::Run(blockCount, threads, [&](size_t b) {
+            uint64_t cursor = info[b].arenaOffset;
+            uint64_t* slots = table.data() + ((size_t)b << BlockOffsetBits);
+            Walk(blocks[b], sizes[b], [&](uint32_t slot, const uint8_t* chars, uint32_t length, bool wide) {
+                char* out = arena.data() + cursor;
+                uint32_t bytes = wide ? EncodeUtf8(chars, length, out) : (memcpy(out, chars, length), length);
+                slots[slot] = cursor << 16 | bytes;
+                cursor += bytes;
+            });
+        });
+
+        // 4. 反向哈希（按 Index 顺序插入，重名时保留最小的 Index）
+        uint32_t capacity = 16;
+        while (capacity < nameCount * 2) capacity <<= 1;
+        lookup.assign(capacity, 0);
+        for (uint32_t id = 0; id < table.size(); id++) {
+            if (!table[id]) continue;
+            std::string_view name = GetName(id);
+            uint64_t hash = FastHash::XXH64(name.data(), name.size());
+            uint32_t mask = capacity - 1;
+            uint32_t slot = (uint32_t)hash & mask;
+            bool duplicate = false;
+            while (lookup[slot]) {
+                if ((uint32_t)(lookup[slot] >> 32) == (uint32_t)(hash >> 32) && GetName((uint32_t)lookup[slot] - 1) == name) {
+                    duplicate = true;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            if (!duplicate) lookup[slot] = (hash >> 32) << 32 | (uint64_t)(id + 1);
+        }
+        return true;
+    }
+
+    // 连续存放的块（dump 文件：第 0 块、第 1 块……依次拼接，最后一块可以不满）
+    bool Build(const uint8_t* dump, size_t size, unsigned threads = 0) {
+        if (size > (size_t)MaxBlocks * BlockBytes) {        // 超过 13 位块号，Index 会溢出
+            Clear();
+            return false;
+        }
+        uint32_t blockCount = (uint32_t)((size + BlockBytes - 1) / BlockBytes);
+        std::vector<const uint8_t*> blocks(blockCount);
+        std::vector<size_t> sizes(blockCount);
+        for (uint32_t b = 0; b < blockCount; b++) {
+            blocks[b] = dump + (size_t)b * BlockBytes;
+            sizes[b] = size - (size_t)b * BlockBytes < BlockBytes ? size - (size_t)b * BlockBytes : BlockBytes;
+        }
+        return Build(blocks.data(), sizes.data(), blockCount, threads);
+    }
+
+    bool LoadFile(const char* path, unsigned threads = 0) {
+        MappedFile file;
+        if (!file.Open(path)) return false;
+        return Build(file.Data(), file.Size(), threads);     // 解码后不再引用文件
+    }
+
+    /*
+     * 从进程/快照读取：blocksAddress 是 FNamePool::Blocks 数组的地址
+     * （GNames 特征码定位到 NamePoolData 后，Blocks 一般在 +0x10）
+     * 块指针数组 1 次读取，所有块再一次批量读取
+     */
+    bool Capture(const ScatterRead::RangeReader& read, uint64_t blocksAddress, uint32_t blockCount,
+                 unsigned threads = 0, size_t pointerBytes = sizeof(uintptr_t)) {
+        if (blockCount == 0 || blockCount > MaxBlocks) return false;
+        std::vector<uint8_t> pointers((size_t)blockCount * pointerBytes);
+        if (!read(blocksAddress, pointers.data(), pointers.size())) return false;
+
+        std::vector<uint8_t> dump((size_t)blockCount * BlockBytes);
+        ScatterRead batch;
+        for (uint32_t b = 0; b < blockCount; b++) {
+            uint64_t block = 0;
+            memcpy(&block, pointers.data() + (size_t)b * pointerBytes, pointerBytes);
+            if (block) batch.Add(block, dump.data() + (size_t)b * BlockBytes, BlockBytes);
+        }
+        batch.Execute(read);        // 读不到的块保持全 0，解码时就是空块
+        return Build(dump.data(), dump.size(), threads);
+    }
+
+    // Index -> 名字（指向 arena，缓存存在期间有效）；不是条目起点的 Index 返回空
+    std::string_view GetName(uint32_t id) const {
+        if (id >= table.size()) return std::string_view();
+        uint64_t packed = table[id];
+        return std::string_view(arena.data() + (packed >> 16), (size_t)(packed & 0xFFFF));
+    }
+
+    // 名字 -> Index（区分大小写）
+    uint32_t Find(std::string_view name) const {
+        if (lookup.empty()) return InvalidId;
+        uint64_t hash = FastHash::XXH64(name.data(), name.size());
+        uint32_t mask = (uint32_t)lookup.size() - 1;
+        for (uint32_t slot = (uint32_t)hash & mask; lookup[slot]; slot = (slot + 1) & mask) {
+            uint64_t value = lookup[slot];
+            if ((uint32_t)(value >> 32) == (uint32_t)(hash >> 32) && GetName((uint32_t)value - 1) == name) {
+                return (uint32_t)value - 1;
+            }
+        }
+        return InvalidId;
+    }
+
+    size_t Count() const { return nameCount; }
+    size_t ArenaBytes() const { return arena.size(); }
+
+    void Clear() {
+        arena.clear();
+        table.clear();
+        lookup.clear();
+        nameCount = 0;
+    }
+
+private:
+    struct BlockInfo {
+        size_t names = 0;
+        uint64_t bytes = 0;
+        uint64_t arenaOffset = 0;
+    };
+
+    // 遍历一个块里的条目：fn(块内槽位, 字符, 长度, 是否宽字符)
+    template<typename Fn>
+    static void Walk(const uint8_t* block, size_t size, Fn fn) {
+        if (!block) return;
+        size_t pos = 0;
+        while (pos + 2 <= size) {
+            uint16_t header;
+            memcpy(&header, block + pos, 2);
+            uint32_t length = header >> 6;
+            if (length == 0) break;
+            bool wide = (header & 1) != 0;
+            size_t bytes = 2 + (size_t)length * (wide ? 2 : 1);
+            if (pos + bytes > size) break;          // 截断的条目
+            fn((uint32_t)(pos / Stride), block + pos + 2, length, wide);
+            pos += (bytes + Stride - 1) / Stride * Stride;
+        }
+    }
+
+    // UTF-16（小端）转 UTF-8：长度 / 编码
+    static uint32_t Utf8Length(const uint8_t* chars, uint32_t length) {
+        uint32_t bytes = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            uint32_t c = Decode16(chars, length, i);
+            bytes += c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+        }
+        return bytes;
+    }
+
+    static uint32_t EncodeUtf8(const uint8_t* chars, uint32_t length, char* out) {
+        uint8_t* p = reinterpret_cast<uint8_t*>(out);
+        for (uint32_t i = 0; i < length; i++) {
+            uint32_t c = Decode16(chars, length, i);
+            if (c < 0x80) {
+                *p++ = (uint8_t)c;
+            }
+            else if (c < 0x800) {
+                *p++ = (uint8_t)(0xC0 | c >> 6);
+                *p++ = (uint8_t)(0x80 | (c & 0x3F));
+            }
+            else if (c < 0x10000) {
+                *p++ = (uint8_t)(0xE0 | c >> 12);
+                *p++ = (uint8_t)(0x80 | (c >> 6 & 0x3F));
+                *p++ = (uint8_t)(0x80 | (c & 0x3F));
+            }
+            else {
+                *p++ = (uint8_t)(0xF0 | c >> 18);
+                *p++ = (uint8_t)(0x80 | (c >> 12 & 0x3F));
+                *p++ = (uint8_t)(0x80 | (c >> 6 & 0x3F));
+                *p++ = (uint8_t)(0x80 | (c & 0x3F));
+            }
+        }
+        return (uint32_t)(p - reinterpret_cast<uint8_t*>(out));
+    }
+
+    // 取第 i 个码点；代理对的高位会吃掉下一个单元（i 前进），孤立代理转成 U+FFFD
+    static uint32_t Decode16(const uint8_t* chars, uint32_t length, uint32_t& i) {
+        uint32_t c = chars[i * 2] | chars[i * 2 + 1] << 8;
+        if (c >= 0xD800 && c < 0xDC00 && i + 1 < length) {
+            uint32_t low = chars[i * 2 + 2] | chars[i * 2 + 3] << 8;
+            if (low >= 0xDC00 && low < 0xE000) {
+                i++;
+                return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            }
+        }
+        return c >= 0xD800 && c < 0xE000 ? 0xFFFD : c;
+    }
+
+    std::vector<char> arena;
+    std::vector<uint64_t> table;        // Index -> arena 偏移 << 16 | 长度
+    std::vector<uint64_t> lookup;       // 哈希标签 << 32 | Index + 1
+    size_t nameCount = 0;
+};
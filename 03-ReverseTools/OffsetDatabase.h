@@ -0,0 +1,352 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：偏移数据库
+ * ========================================
+ *
+ * OFFSET_GameViewport = 0x78、OFFSET_World = 0x80、OFFSET_PlayerArray = 0x2A8 ……
+ * 这些常量散落在各个文件里，游戏一更新就要全部改一遍再重新编译。
+ * 改成一个按 (版本哈希, 类名, 成员名) 索引的数据库文件：
+ *
+ * - 换游戏版本 = 换一个 offsets.db，不用重新编译
+ * - 同一个文件里可以放多个版本，启动时按当前游戏的版本哈希选择
+ * - 版本哈希为 0 的条目是通用默认值，当前版本查不到时回退到它
+ * - 文件直接内存映射，不解析不拷贝；查找是一次哈希 + 几次探测（开放寻址），
+ *   条目再多启动耗时也不变
+ *
+ * 文件格式（小端）：
+ *   头部 | 版本表 | 槽位表 u32[slotCount] | 条目表 | 名字池
+ *   槽位 = 条目下标 + 1（0 表示空），slotCount 为 2 的幂，装载率不超过 50%
+ *   条目：keyHash u64 | build u64 | value u64 | nameOffset u32 | kind u8 | 填充
+ *   名字池："类名\0成员名\0" 依次排列
+ */
+
+#pragma once
+#include "FastHash.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <vector>
+
+// 条目类型：同名的成员偏移和 RVA 互不冲突
+enum class OffsetKind : uint8_t {
+    Member = 0,     // 成员偏移：UGameEngine::GameViewport = 0x78
+    Size = 1,       // 类大小：成员名为空
+    Rva = 2         // 全局变量/函数相对模块基址：类名为空，如 GEngine
+};
+
+namespace OffsetDb {
+
+    struct Header {
+        char magic[4];              // "OFDB"
+        uint32_t version;
+        uint32_t buildCount;
+        uint32_t entryCount;
+        uint32_t slotCount;
+        uint32_t reserved;
+        uint64_t buildsOffset;
+        uint64_t slotsOffset;
+        uint64_t entriesOffset;
+        uint64_t namesOffset;
+        uint64_t namesSize;
+    };
+
+    struct BuildRecord {
+        uint64_t hash;
+        uint32_t labelOffset;       // 名字池中的版本说明（如 "1.0.3 Shipping"）
+        uint32_t reserved;
+    };
+
+    struct Entry {
+        uint64_t keyHash;
+        uint64_t build;
+        uint64_t value;
+        uint32_t nameOffset;
+        uint8_t kind;
+        uint8_t padding[3];
+    };
+
+    constexpr uint32_t Version = 1;
+
+    // (版本, 类型, 类名, 成员名) -> 64 位键
+    inline uint64_t KeyHash(uint64_t build, OffsetKind kind, const char* cls, const char* member) {
+        uint64_t h = FastHash::XXH64(cls, strlen(cls), build ^ ((uint64_t)kind << 56));
+        return FastHash::XXH64(member, strlen(member), h + 0x9E3779B97F4A7C15ULL);
+    }
+}
+
+// ====================================
+// 第一部分：生成数据库（dump 工具 / 手工整理后写出）
+// ====================================
+
+class OffsetDatabaseWriter {
+public:
+    // 登记一个版本（可选，只用于列出文件里有哪些版本）
+    void AddBuild(uint64_t build, const std::string& label) {
+        builds[build] = label;
+    }
+
+    // 同一个键重复添加时以最后一次为准
+    void Add(uint64_t build, const std::string& cls, const std::string& member, uint64_t value,
+             OffsetKind kind = OffsetKind::Member) {
+        if (!builds.count(build)) builds[build] = std::string();
+        entries[{ build, (uint8_t)kind, cls, member }] = value;
+    }
+
+    size_t Count() const { return entries.size(); }
+
+    // 写出（先写临时文件再改名）
+    bool Save(const std::string& path) const {
+        std::string names;
+        auto intern = [&names](const std::string& a, const std::string* b) {
+            uint32_t offset = (uint32_t)names.size();
+            names += a;
+            names += '\0';
+            if (b) {
+                names += *b;
+                names += '\0';
+            }
+            return offset;
+        };
+
+        std::vector<OffsetDb::BuildRecord> buildTable;
+        for (const auto& build : builds) {
+            OffsetDb::BuildRecord record = {};
+            record.hash = build.first;
+            record.labelOffset = intern(build.second, nullptr);
+            buildTable.push_back(record);
+        }
+
+        uint32_t slotCount = 16;
+        while (slotCount < entries.size() * 2) slotCount <<= 1;
+        std::vector<uint32_t> slots(slotCount, 0);
+        std::vector<OffsetDb::Entry> table;
+        table.reserve(entries.size());
+
+        for (const auto& item : entries) {
+            const Key& key = item.first;
+            OffsetDb::Entry entry = {};
+            entry.keyHash = OffsetDb::KeyHash(key.build, (OffsetKind)key.kind, key.cls.c_str(), key.member.c_str());
+            entry.build = key.build;
+            entry.value = item.second;
+            entry.nameOffset = intern(key.cls, &key.member);
+            entry.kind = key.kind;
+            table.push_back(entry);
+
+            uint32_t slot = (uint32_t)entry.keyHash & (slotCount - 1);
+            while (slots[slot]) slot = (slot + 1) & (slotCount - 1);
+            slots[slot] = (uint32_t)table.size();
+        }
+
+        OffsetDb::Header header = {};
+        memcpy(header.magic, "OFDB", 4);
+        header.version = OffsetDb::Version;
+        header.buildCount = (uint32_t)buildTable.size();
+        header.entryCount = (uint32_t)table.size();
+        header.slotCount = slotCount;
+        header.buildsOffset = sizeof(header);
+        header.slotsOffset = header.buildsOffset + buildTable.size() * sizeof(OffsetDb::BuildRecord);
+        header.entriesOffset = header.slotsOffset + (uint64_t)slotCount * sizeof(uint32_t);
+        header.entriesOffset = (header.entriesOffset + 7) & ~7ULL;
+        header.namesOffset = header.entriesOffset + table.size() * sizeof(OffsetDb::Entry);
+        header.namesSize = names.size();
+
+        std::string temp = path + ".tmp";
+        FILE* file = fopen(temp.c_str(), "wb");
+        if (!file) return false;
+        static const uint8_t zeros[8] = {};
+        uint64_t slotsEnd = header.slotsOffset + (uint64_t)slotCount * sizeof(uint32_t);
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+               && (buildTable.empty() || fwrite(buildTable.data(), sizeof(OffsetDb::BuildRecord), buildTable.size(), file) == buildTable.size())
+               && fwrite(slots.data(), sizeof(uint32_t), slots.size(), file) == slots.size()
+               && fwrite(zeros, 1, (size_t)(header.entriesOffset - slotsEnd), file) == header.entriesOffset - slotsEnd
+               && (table.empty() || fwrite(table.data(), sizeof(OffsetDb::Entry), table.size(), file) == table.size())
+               && (names.empty() || fwrite(names.data(), 1, names.size(), file) == names.size());
+        ok = fclose(file) == 0 && ok;
+
+        if (!ok) {
+            remove(temp.c_str());
+            return false;
+        }
+        remove(path.c_str());
+        return rename(temp.c_str(), path.c_str()) == 0;
+    }
+
+private:
+    struct Key {
+        uint64_t build;
+        uint8_t kind;
+        std::string cls;
+        std::string member;
+
+        bool operator<(const Key& other) const {
+            if (build != other.build) return build < other.build;
+            if (kind != other.kind) return kind < other.kind;
+            if (cls != other.cls) return cls < other.cls;
+            return member < other.member;
+        }
+    };
+
+    std::map<uint64_t, std::string> builds;
+    std::map<Key, uint64_t> entries;
+};
+
+// ====================================
+// 第二部分：读取（内存映射 + 开放寻址查找）
+// ====================================
+
+class OffsetDatabase {
+public:
+    // 启动时绑定：把数据库里的值写到已有变量里；查不到的变量保持原值（即默认值）
+    struct Binding {
+        const char* cls;
+        const char* member;
+        uint32_t* target;
+    };
+
+    /*
+     * 版本哈希：取镜像开头的一页（PE 头含 TimeDateStamp、校验和和区段表），
+     * 代价固定，不随镜像大小增长；要更严格时对整个镜像做 ScanCache::HashImage
+     */
+    static uint64_t HashBuild(const uint8_t* image, size_t size) {
+        return FastHash::XXH64(image, size < 4096 ? size : 4096);
+    }
+
+    bool Open(const char* path) {
+        header = nullptr;
+        if (!file.Open(path, MappedFile::AccessHint::Random)) return false;
+        if (!Validate()) {
+            file.Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool IsOpen() const { return header != nullptr; }
+
+    // 选择当前游戏版本（默认 0：只用通用条目）
+    void SelectBuild(uint64_t build) { current = build; }
+    uint64_t CurrentBuild() const { return current; }
+
+    // 文件中的版本是否包含 build
+    bool HasBuild(uint64_t build) const {
+        for (uint32_t i = 0; header && i < header->buildCount; i++) {
+            if (builds[i].hash == build) return true;
+        }
+        return false;
+    }
+
+    std::vector<std::pair<uint64_t, std::string>> Builds() const {
+        std::vector<std::pair<uint64_t, std::string>> result;
+        for (uint32_t i = 0; header && i < header->buildCount; i++) {
+            result.emplace_back(builds[i].hash, std::string(names + builds[i].labelOffset));
+        }
+        return result;
+    }
+
+    size_t Count() const { return header ? header->entryCount : 0; }
+
+    // 当前版本查不到时回退到通用条目（build 0）
+    bool Find(const char* cls, const char* member, OffsetKind kind, uint64_t& value) const {
+        if (!header) return false;
+        if (FindIn(current, cls, member, kind, value)) return true;
+        return current != 0 && FindIn(0, cls, member, kind, value);
+    }
+
+    // 成员偏移，找不到返回 fallback
+    uint32_t Offset(const char* cls, const char* member, uint32_t fallback = 0) const {
+        uint64_t value;
+        return Find(cls, member, OffsetKind::Member, value) ? (uint32_t)value : fallback;
+    }
+
+    uint32_t Size(const char* cls, uint32_t fallback = 0) const {
+        uint64_t value;
+        return Find(cls, "", OffsetKind::Size, value) ? (uint32_t)value : fallback;
+    }
+
+    uint64_t Rva(const char* name, uint64_t fallback = 0) const {
+        uint64_t value;
+        return Find("", name, OffsetKind::Rva, value) ? value : fallback;
+    }
+
+    // 返回没找到的个数
+    size_t Bind(std::initializer_list<Binding> bindings) const {
+        size_t missing = 0;
+        for (const Binding& binding : bindings) {
+            uint64_t value;
+            if (Find(binding.cls, binding.member, OffsetKind::Member, value)) *binding.target = (uint32_t)value;
+            else missing++;
+        }
+        return missing;
+    }
+
+private:
+    bool Validate() {
+        const uint8_t* data = file.Data();
+        uint64_t size = file.Size();
+        if (!data || size < sizeof(OffsetDb::Header)) return false;
+
+        const OffsetDb::Header* h = reinterpret_cast<const OffsetDb::Header*>(data);
+        if (memcmp(h->magic, "OFDB", 4) != 0 || h->version != OffsetDb::Version) return false;
+        if (h->slotCount == 0 || (h->slotCount & (h->slotCount - 1)) != 0 || h->entryCount >= h->slotCount) return false;
+
+        auto inside = [size](uint64_t offset, uint64_t bytes) { return offset <= size && bytes <= size - offset; };
+        if (!inside(h->buildsOffset, (uint64_t)h->buildCount * sizeof(OffsetDb::BuildRecord))) return false;
+        if (!inside(h->slotsOffset, (uint64_t)h->slotCount * sizeof(uint32_t))) return false;
+        if (!inside(h->entriesOffset, (uint64_t)h->entryCount * sizeof(OffsetDb::Entry))) return false;
+        if (!inside(h->namesOffset, h->namesSize)) return false;
+        if (h->buildsOffset % 8 || h->slotsOffset % 4 || h->entriesOffset % 8) return false;
+        if (h->namesSize == 0 || data[h->namesOffset + h->namesSize - 1] != 0) return false;  // 名字池以 \0 结尾
+
+        builds = reinterpret_cast<const OffsetDb::BuildRecord*>(data + h->buildsOffset);
+        slots = reinterpret_cast<const uint32_t*>(data + h->slotsOffset);
+        entries = reinterpret_cast<const OffsetDb::Entry*>(data + h->entriesOffset);
+        names = reinterpret_cast<const char*>(data + h->namesOffset);
+
+        for (uint32_t i = 0; i < h->buildCount; i++) {
+            if (builds[i].labelOffset >= h->namesSize) return false;
+        }
+        for (uint32_t i = 0; i < h->entryCount; i++) {
+            if (entries[i].nameOffset >= h->namesSize) return false;
+        }
+        uint32_t empty = 0;
+        for (uint32_t i = 0; i < h->slotCount; i++) {
+            if (slots[i] > h->entryCount) return false;
+            if (slots[i] == 0) empty++;
+        }
+        if (empty == 0) return false;       // 没有空槽位时探测不会停下来
+        header = h;
+        return true;
+    }
+
+    bool FindIn(uint64_t build, const char* cls, const char* member, OffsetKind kind, uint64_t& value) const {
+        uint64_t hash = OffsetDb::KeyHash(build, kind, cls, member);
+        uint32_t mask = header->slotCount - 1;
+        uint32_t slot = (uint32_t)hash & mask;
+        for (uint32_t probes = 0; probes < header->slotCount && slots[slot]; probes++, slot = (slot + 1) & mask) {
+            const OffsetDb::Entry& entry = entries[slots[slot] - 1];
+            if (entry.keyHash != hash || entry.build != build || entry.kind != (uint8_t)kind) continue;
+
+            // 哈希相同再比一次名字（名字池以 \0 结尾，成员名紧跟在类名后面）
+            const char* storedClass = names + entry.nameOffset;
+            size_t classLength = strlen(storedClass);
+            if (strcmp(storedClass, cls) != 0) continue;
+            if (entry.nameOffset + classLength + 1 >= header->namesSize) continue;
+            if (strcmp(storedClass + classLength + 1, member) != 0) continue;
+
+            value = entry.value;
+            return true;
+        }
+        return false;
+    }
+
+    MappedFile file;
+    const OffsetDb::Header* header = nullptr;
+    const OffsetDb::BuildRecord* builds = nullptr;
+    const uint32_t* slots = nullptr;
+    const OffsetDb::Entry* entries = nullptr;
+    const char* names = nullptr;
+    uint64_t current = 0;
+};
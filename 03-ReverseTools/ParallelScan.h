@@ -0,0 +1,238 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：多线程分块扫描
+ * ========================================
+ *
+ * 大型 UE 游戏的主模块动辄上百 MB，单线程扫描很慢。
+ * 思路：
+ * 1. 把 [0, size) 切成缓存大小的块（默认 256KB）
+ * 2. 每块多读 patternLength - 1 个字节，保证跨块的特征码不会漏掉
+ *    （但只接受起点落在本块内的命中，避免重复）
+ * 3. 每个线程先处理自己的一段块，做完后去别的线程那里"偷"一半
+ * 4. 每块的结果单独存放，最后按块号顺序合并 —— 与单线程结果完全一致
+ */
+
+#pragma once
+#include "PatternScan.h"
+#include "MultiPatternScan.h"
+#include <atomic>
+#include <thread>
+#include <memory>
+
+namespace PatternEngine {
+
+    // ====================================
+    // 第一部分：工作窃取线程池
+    // ====================================
+
+    /*
+     * 每个线程拥有一段连续的块号区间 [next, end)，打包在一个 64 位原子变量里：
+     * - 自己从前面取（next + 1）
+     * - 别人从后面偷一半（end 变小），偷到的区间变成自己的
+     * 两者都用 CAS，不需要锁。
+     */
+    class ChunkStealingPool {
+    public:
+        // 对 [0, chunkCount) 中的每个块调用 work(chunkIndex)
+        template<typename Work>
+        static void Run(size_t chunkCount, unsigned threadCount, Work work) {
+            if (chunkCount == 0) return;
+            if (threadCount == 0) threadCount = DefaultThreadCount();
+            if (threadCount > chunkCount) threadCount = (unsigned)chunkCount;
+
+            if (threadCount <= 1) {
+                for (size_t i = 0; i < chunkCount; i++) work(i);
+                return;
+            }
+
+            std::unique_ptr<Slot[]> slots(new Slot[threadCount]);
+            for (unsigned t = 0; t < threadCount; t++) {
+                uint32_t begin = (uint32_t)(chunkCount * t / threadCount);
+                uint32_t end = (uint32_t)(chunkCount * (t + 1) / threadCount);
+                slots[t].range.store(Pack(begin, end));
+            }
+
+            auto worker = [&](unsigned self) {
+                uint32_t index;
+                for (;;) {
+                    while (PopFront(slots[self], index)) work(index);
+                    if (!StealHalf(slots.get(), threadCount, self)) break;
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (unsigned t = 1; t < threadCount; t++) {
+                threads.emplace_back(worker, t);
+            }
+            worker(0);
+            for (auto& th : threads) th.join();
+        }
+
+        static unsigned DefaultThreadCount() {
+            unsigned n = std::thread::hardware_concurrency();
+            return n ? n : 1;
+        }
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<uint64_t> range{0};
+        };
+
+        static uint64_t Pack(uint32_t begin, uint32_t end) {
+            return ((uint64_t)begin << 32) | end;
+        }
+        static uint32_t Begin(uint64_t r) { return (uint32_t)(r >> 32); }
+        static uint32_t End(uint64_t r) { return (uint32_t)r; }
+
+        static bool PopFront(Slot& slot, uint32_t& index) {
+            uint64_t r = slot.range.load();
+            while (Begin(r) < End(r)) {
+                if (slot.range.compare_exchange_weak(r, Pack(Begin(r) + 1, End(r)))) {
+                    index = Begin(r);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 从剩余最多的线程偷后一半，偷到返回 true
+        static bool StealHalf(Slot* slots, unsigned count, unsigned self) {
+            for (;;) {
+                unsigned victim = count;
+                uint32_t most = 0;
+                for (unsigned t = 0; t < count; t++) {
+                    if (t == self) continue;
+                    uint64_t r = slots[t].range.load();
+                    uint32_t left = End(r) > Begin(r) ? End(r) - Begin(r) : 0;
+                    if (left > most) {
+                        most = left;
+                        victim = t;
+                    }
+                }
+                if (victim == count) return false;  // 全部做完
+
+                uint64_t r = slots[victim].range.load();
+                uint32_t begin = Begin(r);
+                uint32_t end = End(r);
+                if (begin >= end) continue;
+                uint32_t mid = end - (end - begin + 1) / 2;
+                if (slots[victim].range.compare_exchange_strong(r, Pack(begin, mid))) {
+                    slots[self].range.store(Pack(mid, end));
+                    return true;
+                }
+            }
+        }
+    };
+
+    // ====================================
+    // 第二部分：分块扫描
+    // ====================================
+
+    struct ParallelScanOptions {
+        size_t chunkSize = 256 * 1024;  // 约等于 L2 缓存大小
+        unsigned threads = 0;           // 0 = 使用全部硬件线程
+    };
+
+    // 块 i 负责的候选起点 [i * chunkSize, (i + 1) * chunkSize)
+    // 实际读取窗口要多出 overlap = patternLength - 1 字节
+    inline size_t ChunkCount(size_t size, size_t chunkSize) {
+        return (size + chunkSize - 1) / chunkSize;
+    }
+
+    inline size_t ChunkWindow(size_t size, size_t chunkBegin, size_t chunkSize, size_t overlap) {
+        size_t end = chunkBegin + chunkSize + overlap;
+        return (end > size ? size : end) - chunkBegin;
+    }
+
+    // 多线程版 FindAll：结果与 FindAll 完全相同（按地址升序）
+    inline std::vector<size_t> ParallelFindAll(const uint8_t* data, size_t size, const CompiledPattern& p,
+                                               const ParallelScanOptions& options = ParallelScanOptions()) {
+        if (p.Empty() || size <= options.chunkSize) return FindAll(data, size, p);
+
+        const size_t chunkSize = options.chunkSize;
+        const size_t overlap = p.Size() - 1;
+        const size_t chunks = ChunkCount(size, chunkSize);
+        std::vector<std::vector<size_t>> perChunk(chunks);
+
+        ChunkStealingPool::Run(chunks, options.threads, [&](size_t i) {
+            size_t begin = i * chunkSize;
+            size_t window = ChunkWindow(size, begin, chunkSize, overlap);
+            ForEachMatch(data + begin, window, p, [&](size_t offset) {
+                perChunk[i].push_back(begin + offset);
+                return true;
+            });
+        });
+
+        std::vector<size_t> hits;
+        for (auto& list : perChunk) {
+            hits.insert(hits.end(), list.begin(), list.end());
+        }
+        return hits;
+    }
+
+    // 多线程版 FindFirst：一旦某块找到，编号更大的块直接跳过
+    inline const uint8_t* ParallelFindFirst(const uint8_t* data, size_t size, const CompiledPattern& p,
+                                            const ParallelScanOptions& options = ParallelScanOptions()) {
+        if (p.Empty() || size <= options.chunkSize) return FindFirst(data, size, p);
+
+        const size_t chunkSize = options.chunkSize;
+        const size_t overlap = p.Size() - 1;
+        const size_t chunks = ChunkCount(size, chunkSize);
+        std::atomic<size_t> best{SIZE_MAX};
+
+        ChunkStealingPool::Run(chunks, options.threads, [&](size_t i) {
+            size_t begin = i * chunkSize;
+            if (begin >= best.load(std::memory_order_relaxed)) return;
+
+            size_t window = ChunkWindow(size, begin, chunkSize, overlap);
+            const uint8_t* found = FindFirst(data + begin, window, p);
+            if (!found) return;
+
+            size_t offset = (size_t)(found - data);
+            size_t current = best.load();
+            while (offset < current && !best.compare_exchange_weak(current, offset)) {}
+        });
+
+        size_t offset = best.load();
+        return offset == SIZE_MAX ? nullptr : data + offset;
+    }
+
+    // 多特征码 + 多线程：overlap 取最长特征码
+    inline std::vector<std::vector<size_t>> ParallelFindAll(const uint8_t* data, size_t size, const MultiPatternScanner& scanner,
+                                                            const ParallelScanOptions& options = ParallelScanOptions()) {
+        if (size <= options.chunkSize) return scanner.FindAll(data, size);
+
+        size_t longest = 1;
+        for (size_t k = 0; k < scanner.PatternCount(); k++) {
+            if (scanner.GetPattern(k).Size() > longest) longest = scanner.GetPattern(k).Size();
+        }
+
+        const size_t chunkSize = options.chunkSize;
+        const size_t overlap = longest - 1;
+        const size_t chunks = ChunkCount(size, chunkSize);
+        std::vector<std::vector<std::vector<size_t>>> perChunk(chunks);
+
+        ChunkStealingPool::Run(chunks, options.threads, [&](size_t i) {
+            size_t begin = i * chunkSize;
+            size_t window = ChunkWindow(size, begin, chunkSize, overlap);
+            auto& local = perChunk[i];
+            local.resize(scanner.PatternCount());
+            scanner.ForEachMatch(data + begin, window, [&](size_t index, size_t offset) {
+                // 起点不在本块的命中交给下一块（它的窗口从那里开始）
+                // 空特征码只在第 0 块命中一次，与单线程一致
+                if (offset >= chunkSize) return true;
+                if (i > 0 && scanner.GetPattern(index).Empty()) return true;
+                local[index].push_back(begin + offset);
+                return true;
+            });
+        });
+
+        std::vector<std::vector<size_t>> hits(scanner.PatternCount());
+        for (auto& chunk : perChunk) {
+            for (size_t k = 0; k < chunk.size(); k++) {
+                hits[k].insert(hits[k].end(), chunk[k].begin(), chunk[k].end());
+            }
+        }
+        return hits;
+    }
+}
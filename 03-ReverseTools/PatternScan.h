@@ -0,0 +1,327 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：特征码扫描引擎
+ * ========================================
+ *
+ * ReverseTools.h 中的 PatternScanner 负责"找模块"，
+ * 这里负责"在一段内存里找特征码"，并且不依赖 windows.h，
+ * 在 Linux 上也能直接编译测试。
+ *
+ * 核心思路（与 CE 的 AoB 扫描类似）：
+ * 1. 特征码只解析一次（字面量可在编译期解析），得到 value/mask 两组字节
+ * 2. 选出特征码里"最少见"的一个字节作为锚点（anchor）
+ * 3. 用 SSE2/AVX2 一次比较 16/32 个候选位置的锚点字节
+ * 4. 只有锚点命中的位置才做完整的 value/mask 校验
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PATTERN_SCAN_AVX2 1
+#define PATTERN_SCAN_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PATTERN_SCAN_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace PatternEngine {
+
+    // ====================================
+    // 第一部分：特征码预处理
+    // ====================================
+
+    /*
+     * 知识点：value/mask
+     * - "48 8B 05 ?? ?? ?? ??" -> value = {48 8B 05 00 00 00 00}
+     *                             mask  = {FF FF FF 00 00 00 00}
+     * - 匹配条件：(data[i] & mask[i]) == value[i]
+     * - value 中通配符位置预先清零，校验时不用再判断"是不是通配符"
+     *
+     * CompiledPattern 用定长数组把 value 和 mask 连续放在一起：
+     * - 不做任何堆分配，可以放在栈上、全局变量里
+     * - 所有函数都是 constexpr，特征码字面量可以在编译期解析：
+     *   constexpr auto kGEngine = PatternEngine::Compile("48 8B 05 ?? ?? ?? ??");
+     */
+    struct CompiledPattern {
+        static constexpr size_t MaxLength = 128;
+
+        uint8_t value[MaxLength] = {};
+        uint8_t mask[MaxLength] = {};
+        size_t length = 0;
+        size_t anchor = 0;         // 最少见的具体字节
+        size_t second = 0;         // 次少见的具体字节（用于二次过滤）
+        bool hasAnchor = false;    // 全是通配符时为 false
+        bool overflow = false;     // 超过 MaxLength 被截断：扫描引擎不会报告任何命中
+
+        constexpr size_t Size() const { return length; }
+        constexpr bool Empty() const { return length == 0; }
+
+        // 追加一个字节；wildcard 为 true 时该位置匹配任意值
+        constexpr void Append(uint8_t byte, bool wildcard) {
+            if (length == MaxLength) {
+                overflow = true;
+                return;
+            }
+            value[length] = wildcard ? 0x00 : byte;
+            mask[length] = wildcard ? 0x00 : 0xFF;
+            length++;
+        }
+
+        // 追加完成后调用：挑选锚点
+        constexpr void Finalize();
+    };
+
+    // x86-64 代码段中常见字节的大致出现频率（越大越常见）
+    // 未列出的字节视为少见，适合作为锚点
+    constexpr int ByteFrequency(uint8_t b) {
+        switch (b) {
+            case 0x00: return 100;
+            case 0xFF: return 60;
+            case 0x48: return 55;
+            case 0x8B: return 50;
+            case 0xCC: return 45;
+            case 0x89: return 40;
+            case 0x0F: return 35;
+            case 0x4C: return 30;
+            case 0x24: return 30;
+            case 0x8D: return 28;
+            case 0x44: return 25;
+            case 0xE8: return 25;
+            case 0x90: return 22;
+            case 0x01: return 20;
+            case 0x83: return 20;
+            case 0x85: return 18;
+            case 0xC0: return 18;
+            case 0x74: return 16;
+            case 0x08: return 15;
+            case 0x10: return 15;
+            case 0x20: return 14;
+            case 0x49: return 14;
+            case 0x41: return 14;
+            case 0x40: return 12;
+            case 0xC3: return 12;
+            case 0x75: return 12;
+            case 0x33: return 10;
+            case 0xE9: return 10;
+            default:   return 1;
+        }
+    }
+
+    constexpr int HexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // 挑选锚点：最少见的具体字节做 anchor，次少见的做 second
+    constexpr void CompiledPattern::Finalize() {
+        hasAnchor = false;
+        anchor = 0;
+        second = 0;
+        int best = 0x7FFFFFFF;
+        int secondBest = 0x7FFFFFFF;
+        for (size_t i = 0; i < length; i++) {
+            if (mask[i] != 0xFF) continue;
+            int freq = ByteFrequency(value[i]);
+            if (!hasAnchor || freq < best) {
+                if (hasAnchor) {
+                    second = anchor;
+                    secondBest = best;
+                }
+                anchor = i;
+                best = freq;
+                hasAnchor = true;
+            }
+            else if (freq < secondBest || second == anchor) {
+                second = i;
+                secondBest = freq;
+            }
+        }
+        if (hasAnchor && secondBest == 0x7FFFFFFF) {
+            second = anchor;  // 只有一个具体字节
+        }
+    }
+
+    // 编译期触发：特征码字面量超过 MaxLength 时让 constexpr 求值失败
+    // （运行期调用什么也不做，结果带 overflow 标记，扫描时不会命中）
+    inline void PatternTooLong() {}
+
+    // 解析特征码字符串（运行期、编译期都可用）
+    // 支持 "48 8B 05 ?? ?? ?? ??"、"488B05????????"、"48 ? 05"
+    // "?F" 这类半字节通配符按整字节通配处理
+    constexpr CompiledPattern Compile(const char* pattern) {
+        CompiledPattern p;
+        const char* current = pattern;
+
+        while (current && *current) {
+            if (*current == '?') {
+                p.Append(0x00, true);
+                current++;
+                if (*current == '?' || HexDigit(*current) >= 0) current++;
+            }
+            else if (HexDigit(*current) >= 0) {
+                int hi = HexDigit(current[0]);
+                int lo = HexDigit(current[1]);
+                if (lo >= 0) {
+                    p.Append((uint8_t)(hi * 16 + lo), false);
+                    current += 2;
+                }
+                else {
+                    p.Append((uint8_t)hi, false);
+                    current += 1;
+                }
+            }
+            else {
+                current++;  // 空格和其他分隔符
+            }
+        }
+
+        if (p.overflow) PatternTooLong();
+        p.Finalize();
+        return p;
+    }
+
+    // 字面量专用：强制在编译期完成解析（写错或过长直接编译失败）
+    // 用法：auto p = PATTERN_LITERAL("48 8B 05 ?? ?? ?? ??");
+#define PATTERN_LITERAL(str) \
+    ([]() { constexpr PatternEngine::CompiledPattern compiled = PatternEngine::Compile(str); return compiled; }())
+
+    // ====================================
+    // 第二部分：候选位置校验
+    // ====================================
+
+    inline unsigned CountTrailingZeros(uint32_t bits) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, bits);
+        return (unsigned)index;
+#else
+        return (unsigned)__builtin_ctz(bits);
+#endif
+    }
+
+    // 校验 candidate 开始的窗口是否匹配（调用者保证窗口在范围内）
+    inline bool MatchAt(const uint8_t* candidate, const CompiledPattern& p) {
+        const size_t n = p.Size();
+        const uint8_t* value = p.value;
+        const uint8_t* mask = p.mask;
+        size_t j = 0;
+
+#if defined(PATTERN_SCAN_SSE2)
+        // 一次校验 16 字节：(data & mask) == value
+        for (; j + 16 <= n; j += 16) {
+            __m128i d = _mm_loadu_si128((const __m128i*)(candidate + j));
+            __m128i m = _mm_loadu_si128((const __m128i*)(mask + j));
+            __m128i v = _mm_loadu_si128((const __m128i*)(value + j));
+            __m128i eq = _mm_cmpeq_epi8(_mm_and_si128(d, m), v);
+            if (_mm_movemask_epi8(eq) != 0xFFFF) return false;
+        }
+#endif
+        for (; j < n; j++) {
+            if ((candidate[j] & mask[j]) != value[j]) return false;
+        }
+        return true;
+    }
+
+    // ====================================
+    // 第三部分：扫描内核
+    // ====================================
+
+    /*
+     * 遍历所有匹配位置，onHit(offset) 返回 false 时提前结束
+     * 结果顺序与逐字节扫描完全一致（从低地址到高地址）
+     */
+    template<typename OnHit>
+    inline void ForEachMatch(const uint8_t* data, size_t size, const CompiledPattern& p, OnHit onHit) {
+        const size_t n = p.Size();
+        if (p.overflow) return;  // 截断后的特征码会误报，运行期的长特征码由调用方退回逐字节比较
+        if (n == 0) {
+            onHit((size_t)0);  // 空特征码：与原逐字节循环一致，直接命中起始位置
+            return;
+        }
+        if (size < n) return;
+
+        const size_t last = size - n;  // 最后一个候选位置
+        size_t i = 0;
+
+        if (!p.hasAnchor) {
+            // 全是通配符：每个位置都匹配
+            for (; i <= last; i++) {
+                if (!onHit(i)) return;
+            }
+            return;
+        }
+
+        const size_t a0 = p.anchor;
+        const size_t a1 = p.second;
+
+#if defined(PATTERN_SCAN_AVX2)
+        // 读取 data[i + a0 .. i + a0 + 31]，i + 31 <= last 保证不越界
+        const __m256i v0 = _mm256_set1_epi8((char)p.value[a0]);
+        const __m256i v1 = _mm256_set1_epi8((char)p.value[a1]);
+        for (; last >= 31 && i <= last - 31; i += 32) {
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)(data + i + a0));
+            __m256i b1 = _mm256_loadu_si256((const __m256i*)(data + i + a1));
+            uint32_t bits = (uint32_t)_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(b0, v0), _mm256_cmpeq_epi8(b1, v1)));
+            while (bits) {
+                size_t k = i + CountTrailingZeros(bits);
+                if (MatchAt(data + k, p) && !onHit(k)) return;
+                bits &= bits - 1;
+            }
+        }
+#endif
+
+#if defined(PATTERN_SCAN_SSE2)
+        const __m128i w0 = _mm_set1_epi8((char)p.value[a0]);
+        const __m128i w1 = _mm_set1_epi8((char)p.value[a1]);
+        for (; last >= 15 && i <= last - 15; i += 16) {
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(data + i + a0));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(data + i + a1));
+            uint32_t bits = (uint32_t)_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(b0, w0), _mm_cmpeq_epi8(b1, w1)));
+            while (bits) {
+                size_t k = i + CountTrailingZeros(bits);
+                if (MatchAt(data + k, p) && !onHit(k)) return;
+                bits &= bits - 1;
+            }
+        }
+#endif
+
+        // 标量收尾（或没有 SIMD 时的完整路径）
+        const uint8_t anchorValue = p.value[a0];
+        for (; i <= last; i++) {
+            if (data[i + a0] != anchorValue) continue;
+            if (MatchAt(data + i, p) && !onHit(i)) return;
+        }
+    }
+
+    // 返回第一个匹配位置，找不到返回 nullptr
+    inline const uint8_t* FindFirst(const uint8_t* data, size_t size, const CompiledPattern& p) {
+        const uint8_t* found = nullptr;
+        ForEachMatch(data, size, p, [&](size_t offset) {
+            found = data + offset;
+            return false;
+        });
+        return found;
+    }
+
+    // 返回所有匹配位置（相对 data 的偏移）
+    inline std::vector<size_t> FindAll(const uint8_t* data, size_t size, const CompiledPattern& p) {
+        std::vector<size_t> hits;
+        ForEachMatch(data, size, p, [&](size_t offset) {
+            hits.push_back(offset);
+            return true;
+        });
+        return hits;
+    }
+}
@@ -0,0 +1,214 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：指针链批量解析
+ * ========================================
+ *
+ * 一帧里要读的字段通常都挂在同一条链下面：
+ *   GEngine -> GameViewport(+0x78) -> World(+0x80) -> GameState(+0x150) -> ...
+ * 每个字段各走一遍完整的链，读 100 个字段就把前缀重复读 100 次，
+ * 外部进程里每次读都是一次系统调用，这部分开销比字段本身大得多。
+ *
+ * 做法：
+ * - 链只声明一次，按"父节点 + 偏移"组织成一棵前缀树，相同前缀自动合并
+ * - 每个节点缓存"这个地址上存的指针"，带上读取时的帧号（generation）
+ * - BeginFrame() 只把帧号加一，不清空任何东西；缓存是否有效看帧号
+ * - 节点可以设置寿命（几帧内有效），GEngine、GameViewport 这种几乎不变的前缀可以跨帧复用
+ * - 父节点的值变了（版本号变了），子节点的缓存自动作废
+ * 结果：一帧读 100 个字段，共同前缀只走一遍。
+ *
+ * 节点语义和 CE 的指针链一致：
+ *   根节点地址 = 静态地址（比如 GEngine 这个全局变量的地址）
+ *   子节点地址 = [父节点地址] + 偏移
+ *
+ * 注意：不是线程安全的，每个读取线程用自己的解析器。
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <unordered_map>
+#include <vector>
+
+class PointerChainResolver {
+public:
+    // 读取函数：从 address 读 size 字节到 dest，失败返回 false
+    using ReadFn = std::function<bool(uintptr_t address, void* dest, size_t size)>;
+    using ChainId = uint32_t;
+    static constexpr ChainId InvalidChain = 0xFFFFFFFFu;
+
+    struct Stats {
+        uint64_t reads = 0;     // 实际发出的指针读取次数
+        uint64_t hits = 0;      // 命中缓存的次数
+    };
+
+    explicit PointerChainResolver(ReadFn readFn, size_t pointerBytes = sizeof(uintptr_t))
+        : reader(std::move(readFn)), pointerSize(pointerBytes) {}
+
+    // 静态地址作为根（相同地址只建一个节点）
+    ChainId Root(uintptr_t address) {
+        auto it = roots.find(address);
+        if (it != roots.end()) return it->second;
+        Node node;
+        node.base = address;
+        nodes.push_back(node);
+        ChainId id = (ChainId)(nodes.size() - 1);
+        roots.emplace(address, id);
+        return id;
+    }
+
+    // 在已有的链后面接若干跳（相同的"父节点 + 偏移"复用已有节点）
+    ChainId Extend(ChainId parent, std::initializer_list<uint32_t> offsets) {
+        return Extend(parent, offsets.begin(), offsets.end());
+    }
+
+    ChainId Extend(ChainId parent, const std::vector<uint32_t>& offsets) {
+        return Extend(parent, offsets.data(), offsets.data() + offsets.size());
+    }
+
+    // 一次声明完整的链：静态地址 + 偏移列表
+    ChainId Declare(uintptr_t base, std::initializer_list<uint32_t> offsets) {
+        return Extend(Root(base), offsets);
+    }
+
+    ChainId Declare(uintptr_t base, const std::vector<uint32_t>& offsets) {
+        return Extend(Root(base), offsets);
+    }
+
+    // 节点上的指针在多少帧内有效（默认 1：只在本帧内复用）
+    void SetLifetime(ChainId id, uint32_t frames) {
+        nodes[id].lifetime = frames ? frames : 1;
+    }
+
+    // 新的一帧：之前读到的值按各自寿命过期
+    void BeginFrame() { generation++; }
+
+    // 丢掉所有缓存（比如切换地图后）
+    void Invalidate() {
+        for (Node& node : nodes) node.stamp = 0;
+    }
+
+    // 链的最终地址（最后一跳只加偏移，不解引用）
+    bool Resolve(ChainId id, uintptr_t& address) {
+        return AddressOf(id, address);
+    }
+
+    // 链的最终地址上存的指针（带缓存）
+    bool ReadPointer(ChainId id, uintptr_t& value) {
+        const Node& node = Load(id);
+        value = node.value;
+        return node.ok;
+    }
+
+    // 读链末尾的字段（字段本身不缓存，只复用前缀）
+    template<typename T>
+    bool Read(ChainId id, T& out) {
+        uintptr_t address;
+        return AddressOf(id, address) && reader(address, &out, sizeof(T));
+    }
+
+    // 批量解析：results[i] 对应 ids[i]，失败的是 0
+    size_t ResolveAll(const std::vector<ChainId>& ids, std::vector<uintptr_t>& results) {
+        results.assign(ids.size(), 0);
+        size_t resolved = 0;
+        for (size_t i = 0; i < ids.size(); i++) {
+            if (AddressOf(ids[i], results[i])) resolved++;
+            else results[i] = 0;
+        }
+        return resolved;
+    }
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+    size_t NodeCount() const { return nodes.size(); }
+
+private:
+    struct Node {
+        ChainId parent = InvalidChain;
+        uint32_t offset = 0;
+        uintptr_t base = 0;             // 根节点的静态地址
+        uint32_t lifetime = 1;
+        uint64_t stamp = 0;             // 读取时的帧号，0 表示没读过
+        uint64_t version = 0;           // 值每变一次加一
+        uint64_t parentVersion = 0;     // 读取时父节点的版本
+        uintptr_t value = 0;
+        bool ok = false;
+    };
+
+    template<typename It>
+    ChainId Extend(ChainId parent, It first, It last) {
+        ChainId current = parent;
+        for (It it = first; it != last; ++it) {
+            uint64_t key = ((uint64_t)current << 32) | *it;
+            auto found = children.find(key);
+            if (found != children.end()) {
+                current = found->second;
+                continue;
+            }
+            Node node;
+            node.parent = current;
+            node.offset = *it;
+            nodes.push_back(node);
+            ChainId id = (ChainId)(nodes.size() - 1);
+            children.emplace(key, id);
+            current = id;
+        }
+        return current;
+    }
+
+    bool AddressOf(ChainId id, uintptr_t& address) {
+        const Node& node = nodes[id];
+        if (node.parent == InvalidChain) {
+            address = node.base;
+            return true;
+        }
+        const Node& parent = Load(node.parent);
+        address = parent.value + node.offset;
+        return parent.ok && parent.value != 0;
+    }
+
+    // 取节点上的指针：缓存在寿命内且父节点没变就直接用，否则重新读
+    const Node& Load(ChainId id) {
+        Node& node = nodes[id];
+        uint64_t parentVersion = 0;
+        uintptr_t address = node.base;
+        bool reachable = true;
+
+        if (node.parent != InvalidChain) {
+            // 先保证父节点是新的（递归深度就是链长，通常不超过 10）
+            const Node& parent = Load(node.parent);
+            parentVersion = parent.version;
+            address = parent.value + node.offset;
+            reachable = parent.ok && parent.value != 0;
+        }
+
+        if (node.stamp != 0 && generation - node.stamp < node.lifetime && node.parentVersion == parentVersion) {
+            stats.hits++;
+            return node;
+        }
+
+        uintptr_t value = 0;
+        bool ok = false;
+        if (reachable) {
+            uint64_t raw = 0;
+            stats.reads++;
+            ok = reader(address, &raw, pointerSize);
+            value = ok ? (uintptr_t)raw : 0;
+        }
+        if (node.stamp == 0 || value != node.value || ok != node.ok) node.version++;
+        node.value = value;
+        node.ok = ok;
+        node.stamp = generation;
+        node.parentVersion = parentVersion;
+        return node;
+    }
+
+    ReadFn reader;
+    size_t pointerSize;
+    uint64_t generation = 1;
+    std::vector<Node> nodes;
+    std::unordered_map<uintptr_t, ChainId> roots;
+    std::unordered_map<uint64_t, ChainId> children;
+    Stats stats;
+};
@@ -14,6 +14,20 @@
 #include <vector>
 #include <iostream>
 #include <cwchar>
+#include "PatternScan.h"
+#include "MultiPatternScan.h"
+#include "ParallelScan.h"
+#include "ImageSections.h"
+#include "MappedFile.h"
+#include "ScanCache.h"
+#include "IncrementalScan.h"
+#include "PointerChain.h"
+#include "ScatterRead.h"
+#include "ArrayReader.h"
+#include "XrefIndex.h"
+#include "SignatureGen.h"
+#include "OffsetDatabase.h"
+#include "NameCache.h"
 
 // ====================================
 // 第一部分：进程操作工具
@@ -92,6 +106,15 @@ public:
         return ReadProcessMemory(process, (LPVOID)address, &value, sizeof(T), &bytesWritten);
     }
     
+    // 批量读取（外部进程）：先往 batch 里 Add 请求，这里一次执行，相邻字段合并成整页读取
+    // 返回成功的请求数，单个请求是否成功用 batch.Succeeded(i) 查询
+    static size_t ReadScatter(HANDLE process, ScatterRead& batch) {
+        return batch.Execute([process](uint64_t address, void* dest, size_t size) {
+            SIZE_T bytesRead = 0;
+            return ReadProcessMemory(process, (LPCVOID)(uintptr_t)address, dest, size, &bytesRead) && bytesRead == size;
+        });
+    }
+    
     // 读取内存（当前进程）
     template<typename T>
     static T Read(uintptr_t address) {
@@ -130,6 +153,7 @@ public:
     
     // 将特征码字符串转为字节数组
     // 例: "48 8B 05 ?? ?? ?? ??" -> {0x48, 0x8B, 0x05, -1, -1, -1, -1}
+    // 实际扫描使用 PatternEngine::CompiledPattern；超长特征码的逐字节扫描（ScanPatternBytes）用这里的结果
     static std::vector<int> ParsePattern(const char* pattern) {
         std::vector<int> bytes;
         const char* current = pattern;
@@ -154,8 +178,17 @@ public:
     }
     
     // 在内存中搜索特征码
+    // 实际扫描交给 PatternEngine：锚点字节 + SSE2/AVX2 批量比较
     static uintptr_t ScanPattern(uintptr_t start, size_t size, const char* pattern) {
+        PatternEngine::CompiledPattern compiled = PatternEngine::Compile(pattern);
+        if (compiled.overflow) return ScanPatternBytes(start, size, pattern);
+        return ScanPattern(start, size, compiled);
+    }
+    
+    // 逐字节比较：超过 CompiledPattern::MaxLength 的长特征码走这里（任意长度都支持）
+    static uintptr_t ScanPatternBytes(uintptr_t start, size_t size, const char* pattern) {
         std::vector<int> patternBytes = ParsePattern(pattern);
+        if (size < patternBytes.size()) return 0;
         
         for (size_t i = 0; i <= size - patternBytes.size(); i++) {
             bool found = true;
@@ -178,8 +211,26 @@ public:
         return 0;
     }
     
+    // 已编译的特征码：不解析、不分配，适合热路径
+    static uintptr_t ScanPattern(uintptr_t start, size_t size, const PatternEngine::CompiledPattern& pattern) {
+        const uint8_t* found = PatternEngine::FindFirst((const uint8_t*)start, size, pattern);
+        return found ? (uintptr_t)found : 0;
+    }
+    
     // 扫描整个模块
     static uintptr_t ScanModule(const wchar_t* moduleName, const char* pattern) {
+        PatternEngine::CompiledPattern compiled = PatternEngine::Compile(pattern);
+        if (!compiled.overflow) return ScanModule(moduleName, compiled);
+        
+        HMODULE module = GetModuleHandleW(moduleName);
+        MODULEINFO moduleInfo;
+        if (!module || !GetModuleInformation(GetCurrentProcess(), module, &moduleInfo, sizeof(moduleInfo))) {
+            return 0;
+        }
+        return ScanPatternBytes((uintptr_t)module, moduleInfo.SizeOfImage, pattern);
+    }
+    
+    static uintptr_t ScanModule(const wchar_t* moduleName, const PatternEngine::CompiledPattern& pattern) {
         HMODULE module = GetModuleHandleW(moduleName);
         if (!module) return 0;
         
@@ -190,6 +241,129 @@ public:
         
         return ScanPattern((uintptr_t)module, moduleInfo.SizeOfImage, pattern);
     }
+    
+    // 只扫描模块的指定区段（默认 .text），跳过数据/资源/重定位
+    // sections 写法见 ImageFormat::SectionRanges，例如 ".text,.rdata"
+    static uintptr_t ScanModuleSections(const wchar_t* moduleName, const PatternEngine::CompiledPattern& pattern,
+                                        const char* sections = ".text") {
+        HMODULE module = GetModuleHandleW(moduleName);
+        if (!module) return 0;
+        
+        MODULEINFO moduleInfo;
+        if (!GetModuleInformation(GetCurrentProcess(), module, &moduleInfo, sizeof(moduleInfo))) {
+            return 0;
+        }
+        
+        const uint8_t* base = (const uint8_t*)module;
+        ImageFormat::ImageLayout image;
+        if (!ImageFormat::ParsePE(base, moduleInfo.SizeOfImage, image)) {
+            return ScanPattern((uintptr_t)module, moduleInfo.SizeOfImage, pattern);  // 头部异常时退回整模块扫描
+        }
+        
+        size_t offset = PatternEngine::FindFirstInSections(base, moduleInfo.SizeOfImage, image,
+                                                           ImageFormat::Layout::Mapped, pattern, sections);
+        return offset == SIZE_MAX ? 0 : (uintptr_t)module + offset;
+    }
+    
+    // 带缓存的模块扫描：模块文件没变时直接返回上次的结果
+    // 缓存键用磁盘上模块文件的内容哈希（内存中的镜像会被重定位修改，每次启动都不同）
+    // 一个 ScanCache 只对应一个模块：绑定后再传别的模块，直接扫描、不读写缓存
+    static uintptr_t ScanModuleCached(const wchar_t* moduleName, const PatternEngine::CompiledPattern& pattern,
+                                      ScanCache& cache) {
+        HMODULE module = GetModuleHandleW(moduleName);
+        if (!module) return 0;
+        
+        MODULEINFO moduleInfo;
+        if (!GetModuleInformation(GetCurrentProcess(), module, &moduleInfo, sizeof(moduleInfo))) {
+            return 0;
+        }
+        
+        if (!cache.IsBound()) {
+            char modulePath[MAX_PATH] = {0};
+            MappedFile file;
+            if (!GetModuleFileNameA(module, modulePath, MAX_PATH) || !file.Open(modulePath)) {
+                return ScanPattern((uintptr_t)module, moduleInfo.SizeOfImage, pattern);
+            }
+            cache.Bind(ScanCache::HashImage(file.Data(), file.Size()), (uint64_t)(uintptr_t)module);
+        }
+        else if (cache.BoundSource() != (uint64_t)(uintptr_t)module) {
+            return ScanPattern((uintptr_t)module, moduleInfo.SizeOfImage, pattern);   // 缓存里是别的模块的 RVA
+        }
+        
+        // 缓存里存的是相对模块基址的偏移（RVA），与 ASLR 无关
+        auto offsets = cache.GetOrScan(ScanCache::PatternKey(pattern), [&]() {
+            std::vector<uint64_t> result;
+            uintptr_t found = ScanPattern((uintptr_t)module, moduleInfo.SizeOfImage, pattern);
+            if (found) result.push_back(found - (uintptr_t)module);
+            return result;
+        });
+        return offsets.empty() ? 0 : (uintptr_t)module + (uintptr_t)offsets[0];
+    }
+    
+    // 多线程扫描整个模块：按块切分 + 工作窃取，结果与 ScanModule 相同
+    static uintptr_t ScanModuleParallel(const wchar_t* moduleName, const char* pattern,
+                                        const PatternEngine::ParallelScanOptions& options = PatternEngine::ParallelScanOptions()) {
+        HMODULE module = GetModuleHandleW(moduleName);
+        if (!module) return 0;
+        
+        MODULEINFO moduleInfo;
+        if (!GetModuleInformation(GetCurrentProcess(), module, &moduleInfo, sizeof(moduleInfo))) {
+            return 0;
+        }
+        
+        PatternEngine::CompiledPattern compiled = PatternEngine::Compile(pattern);
+        if (compiled.overflow) return ScanPatternBytes((uintptr_t)module, moduleInfo.SizeOfImage, pattern);
+        const uint8_t* found = PatternEngine::ParallelFindFirst((const uint8_t*)module, moduleInfo.SizeOfImage, compiled, options);
+        return found ? (uintptr_t)found : 0;
+    }
+    
+    // 批量扫描整个模块：所有特征码只遍历一遍模块
+    // 返回值与 patterns 一一对应，找不到的为 0
+    static std::vector<uintptr_t> ScanModule(const wchar_t* moduleName, const std::vector<const char*>& patterns) {
+        std::vector<uintptr_t> results(patterns.size(), 0);
+        
+        HMODULE module = GetModuleHandleW(moduleName);
+        if (!module) return results;
+        
+        MODULEINFO moduleInfo;
+        if (!GetModuleInformation(GetCurrentProcess(), module, &moduleInfo, sizeof(moduleInfo))) {
+            return results;
+        }
+        
+        PatternEngine::MultiPatternScanner scanner;
+        for (const char* pattern : patterns) {
+            scanner.Add(pattern);
+        }
+        scanner.Build();
+        
+        auto found = scanner.FindFirst((const uint8_t*)module, moduleInfo.SizeOfImage);
+        for (size_t i = 0; i < found.size(); i++) {
+            results[i] = found[i] ? (uintptr_t)found[i] : 0;
+            if (scanner.GetPattern(i).overflow) {
+                results[i] = ScanPatternBytes((uintptr_t)module, moduleInfo.SizeOfImage, patterns[i]);  // 长特征码单独扫
+            }
+        }
+        return results;
+    }
+    
+    // 为模块内的地址生成最短唯一特征码（唯一性按整个模块判断，与 ScanModule 的扫描范围一致）
+    // 结果的 pattern 直接交给 ScanModule；offset 不为 0 时，ScanModule 的结果 + offset 才是目标
+    static PatternEngine::GeneratedSignature GenerateSignature(const wchar_t* moduleName, uintptr_t address,
+                                                               const PatternEngine::SignatureOptions& options = {}) {
+        HMODULE module = GetModuleHandleW(moduleName);
+        if (!module) return {};
+        
+        MODULEINFO moduleInfo;
+        if (!GetModuleInformation(GetCurrentProcess(), module, &moduleInfo, sizeof(moduleInfo))) {
+            return {};
+        }
+        
+        uintptr_t base = (uintptr_t)module;
+        if (address < base || address >= base + moduleInfo.SizeOfImage) return {};
+        
+        PatternEngine::SignatureGenerator generator((const uint8_t*)module, moduleInfo.SizeOfImage, base);
+        return generator.Generate(address - base, options);
+    }
 };
 
 // ====================================
@@ -214,6 +388,36 @@ public:
     static uintptr_t ParseMovInstruction(uintptr_t instructionAddr) {
         return GetAbsoluteAddress(instructionAddr, 7, 3);
     }
+    
+    // 通用版本：先解码指令长度和操作数位置，不用再手写 (长度, 偏移位置)
+    // mov/lea/cmp [rip+x]、call/jmp/jcc rel32 都可以；不是相对寻址时返回 0
+    static uintptr_t ResolveRelative(uintptr_t instructionAddr) {
+        const uint8_t* code = (const uint8_t*)instructionAddr;
+        X64::Instruction ins;
+        if (!X64::Decode(code, X64::MaxLength, ins)) return 0;
+        if (ins.ripRelative) return (uintptr_t)ins.RipTarget(instructionAddr, code);
+        if (ins.branch != X64::Branch::None) return (uintptr_t)ins.BranchTarget(instructionAddr, code);
+        return 0;
+    }
+    
+    // 对模块的代码区段建一次引用索引（目标 -> 引用指令），之后查"谁引用了 X"是哈希查找
+    static bool BuildModuleXrefs(const wchar_t* moduleName, PatternEngine::XrefIndex& xrefs) {
+        HMODULE module = GetModuleHandleW(moduleName);
+        if (!module) return false;
+        
+        MODULEINFO moduleInfo;
+        if (!GetModuleInformation(GetCurrentProcess(), module, &moduleInfo, sizeof(moduleInfo))) {
+            return false;
+        }
+        
+        ImageFormat::ImageLayout image;
+        if (!ImageFormat::ParsePE((const uint8_t*)module, moduleInfo.SizeOfImage, image)) return false;
+        
+        xrefs.Clear();
+        xrefs.AddImage((const uint8_t*)module, moduleInfo.SizeOfImage, image,
+                       ImageFormat::Layout::Mapped, (uint64_t)(uintptr_t)module);
+        return true;
+    }
 };
 
 // ====================================
@@ -230,12 +434,25 @@ namespace ReverseExamples {
         // 通常GEngine的引用会在特定函数中
         // 例如某个初始化函数会 mov rax, [GEngine]
         
-        const char* pattern = "48 8B 05 ?? ?? ?? ?? 48 85 C0 74";  // 示例特征码
-        uintptr_t found = PatternScanner::ScanModule(nullptr, pattern);
+        // 示例特征码：编译期解析，运行时不再处理字符串
+        static constexpr PatternEngine::CompiledPattern pattern =
+            PatternEngine::Compile("48 8B 05 ?? ?? ?? ?? 48 85 C0 74");
+        
+        // 游戏文件没更新时，第二次运行直接从缓存拿结果
+        ScanCache cache("signatures.cache");
+        cache.Load();
+        uintptr_t found = PatternScanner::ScanModuleCached(nullptr, pattern, cache);
+        cache.Save();
         
         if (found) {
             std::cout << "找到特征码地址: 0x" << std::hex << found << std::dec << std::endl;
             
+            // 游戏更新后旧特征码失效时，用找到的地址重新生成一条最短的唯一特征码
+            auto signature = PatternScanner::GenerateSignature(nullptr, found);
+            if (signature.unique) {
+                std::cout << "最短唯一特征码: " << signature.pattern << std::endl;
+            }
+            
             // 步骤2：解析相对地址
             uintptr_t gEngineAddr = OffsetUtils::ParseMovInstruction(found);
             std::cout << "GEngine地址: 0x" << std::hex << gEngineAddr << std::dec << std::endl;
@@ -243,12 +460,44 @@ namespace ReverseExamples {
             // 步骤3：读取GEngine指针
             uintptr_t gEngine = MemoryUtils::Read<uintptr_t>(gEngineAddr);
             std::cout << "GEngine实例: 0x" << std::hex << gEngine << std::dec << std::endl;
+            
+            // 步骤4：反过来查"谁引用了 GEngine"——索引建一次，每次查询只是一次哈希查找
+            PatternEngine::XrefIndex xrefs;
+            if (OffsetUtils::BuildModuleXrefs(nullptr, xrefs)) {
+                for (const auto& ref : xrefs.References(gEngineAddr)) {
+                    std::cout << "  引用: 0x" << std::hex << ref.from << std::dec
+                              << (ref.kind == PatternEngine::RefKind::Data ? " (数据)" : " (跳转/调用)") << std::endl;
+                }
+            }
         }
         else {
             std::cout << "未找到特征码" << std::endl;
         }
     }
     
+    // 示例：离线扫描磁盘上的游戏文件（不需要启动游戏）
+    void Example_OfflineScan(const char* exePath) {
+        std::cout << "\n=== 示例：离线扫描 " << exePath << " ===" << std::endl;
+        
+        OfflineImage image;
+        if (!image.Open(exePath)) {
+            std::cout << "无法打开文件" << std::endl;
+            return;
+        }
+        
+        static constexpr PatternEngine::CompiledPattern pattern =
+            PatternEngine::Compile("48 8B 05 ?? ?? ?? ?? 48 85 C0 74");
+        size_t offset = image.FindFirst(pattern, ".text");
+        if (offset == SIZE_MAX) {
+            std::cout << "未找到特征码" << std::endl;
+            return;
+        }
+        
+        // 文件偏移换算成 RVA，再加上模块基址就是运行时地址
+        std::cout << "文件偏移: 0x" << std::hex << offset
+                  << "  RVA: 0x" << image.FileOffsetToRva(offset) << std::dec << std::endl;
+    }
+    
     // 示例2：遍历PlayerArray
     void Example_EnumeratePlayers() {
         std::cout << "\n=== 示例：遍历玩家列表 ===" << std::endl;
@@ -263,12 +512,25 @@ namespace ReverseExamples {
          * 3. 继续下一步
          */
         
-        // 假设已知偏移
-        const int OFFSET_GameViewport = 0x78;
-        const int OFFSET_World = 0x80;
-        const int OFFSET_GameState = 0x150;
-        const int OFFSET_PlayerArray = 0x2A8;
-        
+        // 假设已知偏移（默认值）
+        uint32_t OFFSET_GameViewport = 0x78;
+        uint32_t OFFSET_World = 0x80;
+        uint32_t OFFSET_GameState = 0x150;
+        uint32_t OFFSET_PlayerArray = 0x2A8;
+
+        // 有 offsets.db 时按当前游戏版本覆盖：游戏更新后换数据库文件，不用改代码重新编译
+        OffsetDatabase offsets;
+        if (offsets.Open("offsets.db")) {
+            offsets.SelectBuild(OffsetDatabase::HashBuild((const uint8_t*)GetModuleHandleW(nullptr), 4096));
+            size_t missing = offsets.Bind({
+                { "UGameEngine", "GameViewport", &OFFSET_GameViewport },
+                { "UGameViewportClient", "World", &OFFSET_World },
+                { "UWorld", "GameState", &OFFSET_GameState },
+                { "AGameStateBase", "PlayerArray", &OFFSET_PlayerArray },
+            });
+            std::cout << "偏移数据库：" << offsets.Count() << " 条，" << missing << " 个使用默认值" << std::endl;
+        }
+
         // 假设已找到GEngine
         uintptr_t gEngine = 0x12345678;  // 示例地址
         
@@ -303,6 +565,53 @@ namespace ReverseExamples {
             std::cout << "   Player[" << i << "] = 0x" << std::hex << player << std::dec << std::endl;
         }
         */
+        
+        /*
+         * 上面每读一个字段都要从 GEngine 重新走一遍。
+         * 字段一多，改用指针链解析器：链只声明一次，共同前缀每帧只读一次
+         * （gEngineAddr 是 GEngine 这个全局变量的地址，见 Example_FindGEngine）
+         *
+        PointerChainResolver chains([](uintptr_t address, void* dest, size_t size) {
+            if (!address) return false;
+            memcpy(dest, (const void*)address, size);
+            return true;
+        });
+        auto gameState = chains.Declare(gEngineAddr, { OFFSET_GameViewport, OFFSET_World, OFFSET_GameState });
+        auto playerData = chains.Extend(gameState, { OFFSET_PlayerArray });
+        auto playerCount = chains.Extend(gameState, { OFFSET_PlayerArray + 8 });
+        chains.SetLifetime(chains.Root(gEngineAddr), 60);   // GEngine 很少变，60 帧确认一次
+        
+        // 每帧
+        chains.BeginFrame();
+        uintptr_t data;
+        int count;
+        if (chains.ReadPointer(playerData, data) && chains.Read(playerCount, count)) {
+            // 前缀 GEngine -> GameViewport -> World -> GameState 只读了一遍
+            
+            // 元素指针和各元素的字段也不要逐个读：登记后一次执行，连续的指针块合并成一次读取
+            std::vector<uintptr_t> players(count);
+            ScatterRead batch;
+            for (int i = 0; i < count; i++) batch.Add(data + i * 8, players[i]);
+            batch.ExecuteProcess();     // 读自己；外部进程用 MemoryUtils::ReadScatter(process, batch)
+        }
+        
+        // 要的是每个玩家的字段时，直接按列读整个数组：头 1 次 + 指针块 1 次 + 合并后的字段段
+        ArrayReader players = ArrayReader::ForProcess();
+        size_t colId = players.AddField<int32_t>(0x2C0);      // PlayerId
+        size_t colTeam = players.AddField<int32_t>(0x2C4);    // TeamId
+        size_t colName = players.AddField(0x2A0, 32);         // PlayerName[32]
+        
+        ArrayColumns columns;
+        uintptr_t arrayAddress;
+        if (chains.Resolve(playerData, arrayAddress) && players.Read(arrayAddress, columns)) {
+            const int32_t* ids = columns.Column<int32_t>(colId);
+            const int32_t* teams = columns.Column<int32_t>(colTeam);
+            for (size_t i = 0; i < columns.Rows(); i++) {
+                if (!columns.Valid(i)) continue;
+                std::cout << ids[i] << " " << teams[i] << " " << columns.Text(colName, i) << std::endl;
+            }
+        }
+        */
     }
     
     // 示例3：调用游戏函数（ProcessEvent）
@@ -0,0 +1,181 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：特征码结果缓存
+ * ========================================
+ *
+ * 游戏没更新、特征码没改，重启工具后再扫一遍纯属浪费。
+ * 缓存文件记录：
+ *   镜像内容哈希 + (特征码, 区段声明) -> 命中偏移列表
+ * 启动时先查缓存，查不到才真正扫描；
+ * 镜像哈希一变（游戏更新了），整个缓存自动作废。
+ *
+ * 文件格式（小端）：
+ *   "SIGC" | version u32 | imageHash u64 | entryCount u32
+ *   每条：key u64 | hitCount u32 | offsets u64[hitCount]
+ */
+
+#pragma once
+#include "PatternScan.h"
+#include "FastHash.h"
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+class ScanCache {
+public:
+    static constexpr uint32_t Version = 1;
+
+    ScanCache() = default;
+    explicit ScanCache(std::string cachePath) : path(std::move(cachePath)) {}
+
+    // 镜像内容哈希（整个文件或整段内存）
+    static uint64_t HashImage(const uint8_t* data, size_t size) {
+        return FastHash::XXH64(data, size);
+    }
+
+    // 特征码 + 区段声明 -> 缓存键（同一个特征码限定不同区段，结果可能不同）
+    static uint64_t PatternKey(const PatternEngine::CompiledPattern& pattern, const char* sections = nullptr) {
+        uint64_t h = FastHash::XXH64(pattern.value, pattern.Size(), pattern.Size());
+        h = FastHash::XXH64(pattern.mask, pattern.Size(), h);
+        if (sections && *sections) h = FastHash::XXH64(sections, strlen(sections), h);
+        return h;
+    }
+
+    /*
+     * 绑定当前镜像：
+     * - 与缓存文件中的哈希一致：保留已有结果
+     * - 不一致（游戏更新了）：清空所有结果
+     * source 标记这个镜像是谁（比如模块基址），只在内存里：
+     * 一个缓存只对应一个镜像，调用方用 BoundSource() 拒绝别的镜像
+     */
+    void Bind(uint64_t hash, uint64_t source = 0) {
+        if (!bound || hash != imageHash) {
+            if (hash != imageHash) {
+                entries.clear();
+                dirty = true;
+            }
+            imageHash = hash;
+            bound = true;
+        }
+        boundSource = source;
+    }
+
+    bool IsBound() const { return bound; }
+    uint64_t BoundSource() const { return boundSource; }
+    uint64_t ImageHash() const { return imageHash; }
+    size_t EntryCount() const { return entries.size(); }
+
+    // 查缓存：命中返回 true（offsets 可能为空，表示"扫过但没找到"）
+    bool Lookup(uint64_t key, std::vector<uint64_t>& offsets) const {
+        if (!bound) return false;
+        auto it = entries.find(key);
+        if (it == entries.end()) return false;
+        offsets = it->second;
+        return true;
+    }
+
+    void Store(uint64_t key, std::vector<uint64_t> offsets) {
+        if (!bound) return;
+        entries[key] = std::move(offsets);
+        dirty = true;
+    }
+
+    // 先查缓存，查不到就调用 scan() 并记下结果
+    template<typename ScanFn>
+    std::vector<uint64_t> GetOrScan(uint64_t key, ScanFn scan) {
+        std::vector<uint64_t> offsets;
+        if (Lookup(key, offsets)) return offsets;
+        offsets = scan();
+        Store(key, offsets);
+        return offsets;
+    }
+
+    // 读缓存文件；文件不存在或损坏时当作空缓存
+    bool Load() {
+        entries.clear();
+        bound = false;
+        boundSource = 0;
+        dirty = false;
+
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) return false;
+
+        // 文件大小：条目里的命中数来自文件，分配前先确认剩下的字节够不够
+        long fileSize = -1;
+        if (fseek(file, 0, SEEK_END) == 0) fileSize = ftell(file);
+        if (fileSize < 0 || fseek(file, 0, SEEK_SET) != 0) {
+            fclose(file);
+            return false;
+        }
+
+        char magic[4];
+        uint32_t version = 0, count = 0;
+        uint64_t hash = 0;
+        bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, "SIGC", 4) == 0
+               && fread(&version, sizeof(version), 1, file) == 1 && version == Version
+               && fread(&hash, sizeof(hash), 1, file) == 1
+               && fread(&count, sizeof(count), 1, file) == 1;
+
+        std::unordered_map<uint64_t, std::vector<uint64_t>> loaded;
+        for (uint32_t i = 0; ok && i < count; i++) {
+            uint64_t key = 0;
+            uint32_t hits = 0;
+            ok = fread(&key, sizeof(key), 1, file) == 1 && fread(&hits, sizeof(hits), 1, file) == 1;
+            if (!ok) break;
+            long position = ftell(file);
+            if (position < 0 || (uint64_t)hits * sizeof(uint64_t) > (uint64_t)(fileSize - position)) {
+                ok = false;     // 截断或损坏
+                break;
+            }
+            std::vector<uint64_t> offsets(hits);
+            if (hits) ok = fread(offsets.data(), sizeof(uint64_t), hits, file) == hits;
+            loaded[key] = std::move(offsets);
+        }
+        fclose(file);
+
+        if (!ok) return false;
+        entries = std::move(loaded);
+        imageHash = hash;
+        return true;
+    }
+
+    // 有改动时写回（先写临时文件再改名，避免写一半崩溃损坏缓存）
+    bool Save() {
+        if (!dirty || !bound) return true;
+
+        std::string temp = path + ".tmp";
+        FILE* file = fopen(temp.c_str(), "wb");
+        if (!file) return false;
+
+        uint32_t count = (uint32_t)entries.size();
+        bool ok = fwrite("SIGC", 1, 4, file) == 4
+               && fwrite(&Version, sizeof(Version), 1, file) == 1
+               && fwrite(&imageHash, sizeof(imageHash), 1, file) == 1
+               && fwrite(&count, sizeof(count), 1, file) == 1;
+        for (const auto& entry : entries) {
+            if (!ok) break;
+            uint32_t hits = (uint32_t)entry.second.size();
+            ok = fwrite(&entry.first, sizeof(entry.first), 1, file) == 1
+              && fwrite(&hits, sizeof(hits), 1, file) == 1
+              && (hits == 0 || fwrite(entry.second.data(), sizeof(uint64_t), hits, file) == hits);
+        }
+        ok = (fclose(file) == 0) && ok;
+        if (!ok) {
+            remove(temp.c_str());
+            return false;
+        }
+
+        remove(path.c_str());  // Windows 上 rename 不能覆盖已有文件
+        if (rename(temp.c_str(), path.c_str()) != 0) return false;
+        dirty = false;
+        return true;
+    }
+
+private:
+    std::string path;
+    uint64_t imageHash = 0;
+    bool bound = false;
+    uint64_t boundSource = 0;
+    bool dirty = false;
+    std::unordered_map<uint64_t, std::vector<uint64_t>> entries;
+};
@@ -0,0 +1,230 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：批量分散读取
+ * ========================================
+ *
+ * MemoryUtils::ReadMemory<T> 每个字段一次调用，遍历玩家列表时
+ * Data、Count、每个元素、每个元素的字段……全是几字节的小读取，
+ * 外部进程里每次都是一次系统调用，时间几乎全花在调用本身上。
+ *
+ * 分散读取的思路：
+ * 1. 先把要读的 (地址, 大小, 目标位置) 都登记下来，不立即读
+ * 2. 按地址排序，每个请求扩展到整页，重叠或相邻的页合并成一段
+ * 3. 每段一次大读取（Linux 上多段还能用一次 process_vm_readv 读完）
+ * 4. 再从缓冲区把数据拷到各自的目标位置
+ * 某一段读失败（比如中间有一页已经释放）时，这一段里的请求退回逐个读取，
+ * 不会因为邻居的失败把本来能读的字段也丢掉。
+ *
+ * 数据来源可以是任何"按地址读一段"的函数：
+ *   进程（ReadProcessMemory / process_vm_readv）、快照文件（SnapshotFile::Reader）、内存 dump
+ * 注意整页读取会越过请求的边界：读自己时用 ExecuteProcess，不要传直接 memcpy 的函数。
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+class ScatterRead {
+public:
+    // 读一段连续内存：失败返回 false（与 Snapshot::MemoryReader 签名相同）
+    using RangeReader = std::function<bool(uint64_t address, void* dest, size_t size)>;
+
+    static constexpr uint64_t PageSize = 4096;
+    static constexpr size_t MaxVectors = 1024;     // Linux IOV_MAX
+
+    struct Stats {
+        size_t requests = 0;    // 登记的请求数
+        size_t spans = 0;       // 合并后的整页段数
+        size_t bytes = 0;       // 实际读取的字节数
+        size_t calls = 0;       // 读取调用（系统调用）次数，含失败后的逐个重读
+    };
+
+    // 登记一个请求，返回序号（用于 Succeeded 查询）
+    size_t Add(uint64_t address, void* dest, size_t size) {
+        requests.push_back({ address, size, dest });
+        return requests.size() - 1;
+    }
+
+    template<typename T>
+    size_t Add(uint64_t address, T& out) {
+        return Add(address, &out, sizeof(T));
+    }
+
+    // 用任意读取函数执行：每个合并段调用一次，返回成功的请求数
+    size_t Execute(const RangeReader& read) {
+        Build();
+        for (size_t s = 0; s < spans.size(); s++) {
+            stats.calls++;
+            spanOk[s] = read(spans[s].address, buffer.data() + spans[s].offset, (size_t)spans[s].size) ? 1 : 0;
+        }
+        return Deliver(read);
+    }
+
+    /*
+     * 直接读进程（pid 为 0 表示当前进程）
+     * Linux：一次 process_vm_readv 最多带 1024 段，部分失败时从失败的那一段接着读
+     * Windows：ReadProcessMemory 不支持多段，每段一次调用（合并本身已经省掉了大部分调用）
+     */
+    size_t ExecuteProcess(uint32_t pid = 0) {
+#ifdef _WIN32
+        HANDLE process = pid ? OpenProcess(PROCESS_VM_READ, FALSE, pid) : GetCurrentProcess();
+        if (!process) {
+            Build();
+            return Deliver([](uint64_t, void*, size_t) { return false; });
+        }
+        size_t ok = Execute([process](uint64_t address, void* dest, size_t size) {
+            SIZE_T read = 0;
+            return ReadProcessMemory(process, (LPCVOID)(uintptr_t)address, dest, size, &read) && read == size;
+        });
+        if (pid) CloseHandle(process);
+        return ok;
+#else
+        pid_t target = pid ? (pid_t)pid : getpid();
+        Build();
+
+        std::vector<struct iovec> local, remote;
+        size_t s = 0;
+        while (s < spans.size()) {
+            size_t n = spans.size() - s < MaxVectors ? spans.size() - s : MaxVectors;
+            local.resize(n);
+            remote.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                const Span& span = spans[s + i];
+                local[i] = { buffer.data() + span.offset, (size_t)span.size };
+                remote[i] = { (void*)(uintptr_t)span.address, (size_t)span.size };
+            }
+
+            stats.calls++;
+            ssize_t got = process_vm_readv(target, local.data(), n, remote.data(), n, 0);
+            uint64_t remaining = got > 0 ? (uint64_t)got : 0;
+
+            // 完整读到的段算成功；停下来的那一段算失败（稍后逐个重读），从下一段接着读
+            size_t done = 0;
+            while (done < n && remaining >= spans[s + done].size) {
+                remaining -= spans[s + done].size;
+                spanOk[s + done] = 1;
+                done++;
+            }
+            if (done < n) spanOk[s + done++] = 0;
+            s += done;
+        }
+
+        return Deliver([target](uint64_t address, void* dest, size_t size) {
+            struct iovec l = { dest, size };
+            struct iovec r = { (void*)(uintptr_t)address, size };
+            return process_vm_readv(target, &l, 1, &r, 1, 0) == (ssize_t)size;
+        });
+#endif
+    }
+
+    bool Succeeded(size_t index) const { return index < status.size() && status[index]; }
+    size_t Size() const { return requests.size(); }
+    const Stats& GetStats() const { return stats; }
+
+    // 清空请求（保留缓冲区容量，下一帧复用）
+    void Clear() {
+        requests.clear();
+        status.clear();
+        spans.clear();
+        spanOk.clear();
+        stats = Stats();
+    }
+
+private:
+    struct Request {
+        uint64_t address;
+        size_t size;
+        void* dest;
+    };
+
+    struct Span {
+        uint64_t address;
+        uint64_t size;
+        size_t offset;          // 在 buffer 中的位置
+        size_t first, last;     // order[first, last) 是落在这一段里的请求
+    };
+
+    // 排序 + 整页对齐 + 合并
+    void Build() {
+        stats.requests = requests.size();
+        status.assign(requests.size(), 0);
+        order.clear();
+        for (size_t i = 0; i < requests.size(); i++) {
+            const Request& r = requests[i];
+            if (r.size == 0) status[i] = 1;
+            else if (r.address + r.size >= r.address) order.push_back(i);   // 跳过地址回绕的请求
+        }
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return requests[a].address < requests[b].address;
+        });
+
+        spans.clear();
+        size_t total = 0;
+        for (size_t k = 0; k < order.size(); k++) {
+            const Request& r = requests[order[k]];
+            uint64_t low = r.address & ~(PageSize - 1);
+            uint64_t end = r.address + r.size;
+            uint64_t high = end > ~(PageSize - 1) ? end : (end + PageSize - 1) & ~(PageSize - 1);
+
+            if (!spans.empty() && low <= spans.back().address + spans.back().size) {
+                Span& span = spans.back();
+                if (high > span.address + span.size) {
+                    total += (size_t)(high - (span.address + span.size));
+                    span.size = high - span.address;
+                }
+                span.last = k + 1;
+            }
+            else {
+                spans.push_back({ low, high - low, total, k, k + 1 });
+                total += (size_t)(high - low);
+            }
+        }
+
+        buffer.resize(total);
+        spanOk.assign(spans.size(), 0);
+        stats.spans = spans.size();
+        stats.bytes = total;
+    }
+
+    // 把成功段的数据拷给各个请求；失败段里的请求逐个重读
+    size_t Deliver(const RangeReader& fallback) {
+        for (size_t s = 0; s < spans.size(); s++) {
+            const Span& span = spans[s];
+            for (size_t k = span.first; k < span.last; k++) {
+                size_t index = order[k];
+                const Request& r = requests[index];
+                if (spanOk[s]) {
+                    memcpy(r.dest, buffer.data() + span.offset + (size_t)(r.address - span.address), r.size);
+                    status[index] = 1;
+                }
+                else {
+                    stats.calls++;
+                    status[index] = fallback(r.address, r.dest, r.size) ? 1 : 0;
+                }
+            }
+        }
+
+        size_t succeeded = 0;
+        for (uint8_t ok : status) succeeded += ok;
+        return succeeded;
+    }
+
+    std::vector<Request> requests;
+    std::vector<uint8_t> status;
+    std::vector<size_t> order;
+    std::vector<Span> spans;
+    std::vector<uint8_t> spanOk;
+    std::vector<uint8_t> buffer;
+    Stats stats;
+};
@@ -0,0 +1,245 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：特征码自动生成
+ * ========================================
+ *
+ * 游戏每次更新后手工维护 "48 8B 05 ?? ?? ?? ?? 48 85 C0 74" 这样的特征码最费时间。
+ * 给定一个地址，自动找出能唯一定位它的最短特征码：
+ *
+ * 1. 从目标地址开始逐条解码指令（XrefIndex.h 的长度解码器），拼出字节模板：
+ *    - RIP 相对位移、call/jmp/jcc 的 rel32 -> 通配符（重新编译后一定会变）
+ *    - 落在模块范围内的 imm32/imm64/disp32 -> 通配符（绝对地址，重定位后会变）
+ *    - 其它字节（操作码、寄存器、结构体偏移、小常量）保留
+ * 2. 模板的每个前缀都是一个候选特征码（长度越长命中越少，满足单调性）
+ * 3. 所有候选一起放进 MultiPatternScanner，整个扫描范围只扫一遍，
+ *    数出每个候选的命中数，取"只命中目标自己"的最短前缀
+ * 4. 从目标开始找不到唯一特征码时（比如目标前后是重复的内联代码），
+ *    再尝试从目标之前的指令边界开始，这时结果带一个偏移：目标 = 命中地址 + offset
+ *
+ * 输出的字符串直接交给 PatternScanner::ScanModule / Compile 使用。
+ * 唯一性按调用方将要扫描的范围判断（整个模块 / 指定区段），两边范围要一致。
+ */
+
+#pragma once
+#include "XrefIndex.h"
+#include "MultiPatternScan.h"
+#include <string>
+#include <vector>
+
+namespace PatternEngine {
+
+    struct SignatureOptions {
+        size_t minLength = 5;                   // 太短的特征码即使唯一也很脆弱
+        size_t maxLength = 64;                  // 不超过 CompiledPattern::MaxLength
+        size_t maxBackward = 32;                // 从目标之前多少字节内的指令边界开始尝试
+        bool wildcardAddresses = true;          // 模块范围内的 imm32/imm64/disp32 换成通配符
+        const char* sections = nullptr;         // 唯一性检查范围，写法见 ImageFormat::SectionRanges；nullptr 为全部数据
+    };
+
+    struct GeneratedSignature {
+        std::string pattern;        // "48 8B 05 ?? ?? ?? ?? 48 85 C0"
+        size_t offset = 0;          // 目标 = 特征码命中位置 + offset（从目标开始时为 0）
+        size_t length = 0;          // 字节数
+        bool unique = false;        // false：最长也不唯一，pattern 是最长的那个
+    };
+
+    class SignatureGenerator {
+    public:
+        /*
+         * data/size：模块内容（内存布局或文件布局都可以，偏移都相对 data）
+         * moduleBase：data 对应的运行时地址，用于判断立即数是不是模块内的绝对地址
+         */
+        SignatureGenerator(const uint8_t* data, size_t size, uint64_t moduleBase = 0)
+            : data(data), size(size), addressLow(moduleBase), addressHigh(moduleBase + size) {}
+
+        // 提供区段表后，options.sections 才能限定唯一性检查范围
+        void SetImage(const ImageFormat::ImageLayout& layout, ImageFormat::Layout kind) {
+            image = &layout;
+            imageLayout = kind;
+            uint64_t end = 0;
+            for (const auto& section : layout.sections) {
+                if (section.virtualAddress + section.virtualSize > end) end = section.virtualAddress + section.virtualSize;
+            }
+            if (end > size) addressHigh = addressLow + end;
+        }
+
+        GeneratedSignature Generate(size_t target, const SignatureOptions& options = SignatureOptions()) const {
+            return GenerateMany(std::vector<size_t>{ target }, options)[0];
+        }
+
+        // 多个目标一起生成：全部候选放进同一个自动机，整个范围仍然只扫一遍
+        std::vector<GeneratedSignature> GenerateMany(const std::vector<size_t>& targets,
+                                                     const SignatureOptions& options = SignatureOptions()) const {
+            size_t maxLength = options.maxLength < CompiledPattern::MaxLength ? options.maxLength : CompiledPattern::MaxLength;
+            size_t minLength = options.minLength ? options.minLength : 1;
+
+            // 1. 每个目标的起点（目标自己 + 之前的指令边界）和字节模板
+            struct Start {
+                size_t target;
+                size_t start;
+                Template bytes;
+                size_t firstCandidate;      // candidates 中的下标范围
+                size_t candidateCount;
+            };
+            std::vector<Start> starts;
+            for (size_t t = 0; t < targets.size(); t++) {
+                for (size_t start : CandidateStarts(targets[t], options.maxBackward)) {
+                    starts.push_back({ t, start, BuildTemplate(start, maxLength, options.wildcardAddresses), 0, 0 });
+                }
+            }
+
+            // 2. 每个模板的前缀 -> 候选（末尾是通配符的前缀和更短的那个等价，跳过）
+            MultiPatternScanner scanner;
+            std::vector<size_t> candidateLength;
+            for (Start& s : starts) {
+                s.firstCandidate = candidateLength.size();
+                for (size_t length = minLength; length <= s.bytes.value.size(); length++) {
+                    if (!s.bytes.mask[length - 1]) continue;
+                    scanner.Add(ToPattern(s.bytes, length));
+                    candidateLength.push_back(length);
+                }
+                s.candidateCount = candidateLength.size() - s.firstCandidate;
+            }
+            scanner.Build();
+
+            // 3. 一遍扫描，数出每个候选的命中（到 2 为止就够了）
+            std::vector<uint8_t> hits(candidateLength.size(), 0);
+            std::vector<size_t> firstHit(candidateLength.size(), SIZE_MAX);
+            for (const auto& range : ScanRanges(options.sections)) {
+                scanner.ForEachMatch(data + range.offset, range.size, [&](size_t index, size_t offset) {
+                    if (hits[index] < 2) hits[index]++;
+                    if (firstHit[index] == SIZE_MAX) firstHit[index] = range.offset + offset;
+                    return true;
+                });
+            }
+
+            // 4. 每个目标：优先从目标开始的最短唯一前缀，其次从之前边界开始的最短唯一前缀
+            std::vector<GeneratedSignature> results(targets.size());
+            std::vector<uint8_t> done(targets.size(), 0);
+            for (const Start& s : starts) {
+                GeneratedSignature& result = results[s.target];
+                bool forward = s.start == targets[s.target];
+                if (!forward && done[s.target]) continue;      // 从目标开始已经唯一：不要带偏移的
+
+                size_t best = SIZE_MAX;
+                for (size_t index = s.firstCandidate; index < s.firstCandidate + s.candidateCount; index++) {
+                    if (hits[index] == 1 && firstHit[index] == s.start) {
+                        best = index;
+                        break;
+                    }
+                }
+
+                if (best != SIZE_MAX && (!result.unique || candidateLength[best] < result.length)) {
+                    result.pattern = ToString(s.bytes, candidateLength[best]);
+                    result.offset = targets[s.target] - s.start;
+                    result.length = candidateLength[best];
+                    result.unique = true;
+                }
+                else if (forward && !s.bytes.value.empty()) {
+                    // 暂时记下最长的（不唯一）；之后的起点找到唯一的会替换掉
+                    result.pattern = ToString(s.bytes, s.bytes.value.size());
+                    result.length = s.bytes.value.size();
+                }
+                if (forward && result.unique) done[s.target] = 1;
+            }
+            return results;
+        }
+
+        // 模板转特征码字符串（"48 8B ?? ..."，与 Compile 的写法一致）
+        static std::string ToString(const uint8_t* value, const uint8_t* mask, size_t length) {
+            static const char hex[] = "0123456789ABCDEF";
+            std::string text;
+            for (size_t i = 0; i < length; i++) {
+                if (i) text += ' ';
+                if (mask[i]) {
+                    text += hex[value[i] >> 4];
+                    text += hex[value[i] & 15];
+                }
+                else {
+                    text += "??";
+                }
+            }
+            return text;
+        }
+
+    private:
+        struct Template {
+            std::vector<uint8_t> value;
+            std::vector<uint8_t> mask;      // 0xFF 具体字节，0 通配符
+        };
+
+        static std::string ToString(const Template& t, size_t length) {
+            return ToString(t.value.data(), t.mask.data(), length);
+        }
+
+        static CompiledPattern ToPattern(const Template& t, size_t length) {
+            CompiledPattern p;
+            for (size_t i = 0; i < length; i++) p.Append(t.value[i], t.mask[i] == 0);
+            p.Finalize();
+            return p;
+        }
+
+        bool IsAddress(uint64_t value) const {
+            return value >= addressLow && value < addressHigh;
+        }
+
+        // 从 start 逐条解码，直到够 maxLength 字节或遇到无法解码的字节
+        Template BuildTemplate(size_t start, size_t maxLength, bool wildcardAddresses) const {
+            Template t;
+            size_t pos = start;
+            while (pos < size && t.value.size() < maxLength) {
+                X64::Instruction ins;
+                if (!X64::Decode(data + pos, size - pos, ins)) break;
+                const uint8_t* code = data + pos;
+                size_t first = t.value.size();
+                t.value.insert(t.value.end(), code, code + ins.length);
+                t.mask.insert(t.mask.end(), ins.length, 0xFF);
+
+                bool wildDisp = ins.ripRelative ||
+                    (wildcardAddresses && ins.dispSize == 4 && IsAddress((uint32_t)ins.Displacement(code)));
+                bool wildImm = (ins.branch != X64::Branch::None && ins.immSize == 4) ||
+                    (wildcardAddresses && ins.immSize == 8 && IsAddress((uint64_t)ins.Immediate(code))) ||
+                    (wildcardAddresses && ins.immSize == 4 && ins.branch == X64::Branch::None &&
+                     IsAddress((uint32_t)ins.Immediate(code)));
+                if (wildDisp) memset(t.mask.data() + first + ins.dispOffset, 0, ins.dispSize);
+                if (wildImm) memset(t.mask.data() + first + ins.immOffset, 0, ins.immSize);
+                pos += ins.length;
+            }
+            if (t.value.size() > maxLength) {
+                t.value.resize(maxLength);
+                t.mask.resize(maxLength);
+            }
+            return t;
+        }
+
+        // 目标本身 + 目标之前、解码后能正好落到目标上的指令边界（近的在前）
+        std::vector<size_t> CandidateStarts(size_t target, size_t maxBackward) const {
+            std::vector<size_t> result{ target };
+            if (target >= size) return result;
+            std::vector<uint8_t> seen(maxBackward + 1, 0);
+            for (size_t back = 1; back <= maxBackward && back <= target; back++) {
+                // 从 target - back 开始解码，能正好落到 target 上就是一条合法的指令链
+                size_t pos = target - back;
+                X64::Instruction ins;
+                while (pos < target && X64::Decode(data + pos, size - pos, ins)) pos += ins.length;
+                if (pos == target) seen[back] = 1;
+            }
+            for (size_t back = 1; back <= maxBackward; back++) {
+                if (seen[back]) result.push_back(target - back);
+            }
+            return result;
+        }
+
+        std::vector<ImageFormat::ByteRange> ScanRanges(const char* sections) const {
+            if (image && sections && *sections) return ImageFormat::SectionRanges(*image, size, imageLayout, sections);
+            return { ImageFormat::ByteRange{ 0, size } };
+        }
+
+        const uint8_t* data;
+        size_t size;
+        uint64_t addressLow;
+        uint64_t addressHigh;
+        const ImageFormat::ImageLayout* image = nullptr;
+        ImageFormat::Layout imageLayout = ImageFormat::Layout::Mapped;
+    };
+}
@@ -0,0 +1,521 @@
+/*
+ * ========================================
+ * UE游戏逆向学习 - 第三课补充：RIP 相对引用索引
+ * ========================================
+ *
+ * OffsetUtils::ParseMovInstruction 只认识一种写死的编码（48 8B 05 + disp32，长度 7），
+ * 找 GEngine 也只能先用特征码扫出那条 mov。换个思路：
+ *
+ * 1. 对代码区段做一次线性反汇编，只算长度（不需要完整的反汇编器）
+ * 2. 记录每条指令里的"相对地址"：
+ *    - RIP 相对的内存操作数：mov rax,[rip+x] / lea rcx,[rip+x] / cmp [rip+x],0 ...
+ *    - call rel32 / jmp rel32 / jcc rel32
+ * 3. 按目标地址建索引：目标 -> 引用它的指令列表
+ * 之后"谁引用了这个全局变量 / 谁调用了这个函数"就是一次哈希查找，不用再扫特征码。
+ *
+ * 线性扫描的局限：代码区段里夹着的跳转表、对齐填充会被当成指令解码，
+ * 偶尔产生假引用。x86 指令流几条指令内就会重新对齐，
+ * 目标地址再限定在模块范围内，假引用很少。
+ */
+
+#pragma once
+#include "ImageSections.h"
+#include "ParallelScan.h"
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+// ====================================
+// 第一部分：x86-64 指令长度解码
+// ====================================
+
+namespace X64 {
+
+    enum class Branch : uint8_t {
+        None,
+        Call,           // E8 rel32
+        Jump,           // E9 rel32 / EB rel8
+        JumpCond        // 0F 8x rel32 / 7x rel8 / E0-E3 rel8
+    };
+
+    /*
+     * 解码结果只记录"各部分在哪"，够算长度、算相对目标、生成通配符特征码：
+     *   [前缀][REX/VEX/EVEX][操作码][ModRM][SIB][位移][立即数]
+     * 相对跳转的 rel8/rel32 记在 imm 里（branch != None）
+     */
+    struct Instruction {
+        uint8_t length = 0;
+        uint8_t opcodeOffset = 0;   // 第一个操作码字节（VEX/EVEX 时是 C4/C5/62）
+        uint8_t dispOffset = 0;
+        uint8_t dispSize = 0;       // 0 / 1 / 4
+        uint8_t immOffset = 0;
+        uint8_t immSize = 0;        // 0 / 1 / 2 / 3(ENTER) / 4 / 8
+        bool ripRelative = false;   // 位移是相对下一条指令的
+        Branch branch = Branch::None;
+
+        // 位移 / 立即数（有符号扩展）
+        int64_t Displacement(const uint8_t* code) const { return ReadSigned(code + dispOffset, dispSize); }
+        int64_t Immediate(const uint8_t* code) const { return ReadSigned(code + immOffset, immSize); }
+
+        // RIP 相对操作数的目标：下一条指令地址 + disp32（立即数在位移后面，所以必须用完整长度）
+        uint64_t RipTarget(uint64_t address, const uint8_t* code) const {
+            return address + length + (uint64_t)Displacement(code);
+        }
+
+        // 相对跳转/调用的目标
+        uint64_t BranchTarget(uint64_t address, const uint8_t* code) const {
+            return address + length + (uint64_t)Immediate(code);
+        }
+
+    private:
+        static int64_t ReadSigned(const uint8_t* p, uint8_t size) {
+            switch (size) {
+            case 1: return (int8_t)p[0];
+            case 2: { int16_t v; memcpy(&v, p, 2); return v; }
+            case 4: { int32_t v; memcpy(&v, p, 4); return v; }
+            case 8: { int64_t v; memcpy(&v, p, 8); return v; }
+            default: return 0;
+            }
+        }
+    };
+
+    namespace Detail {
+
+        // 操作码属性：高位 = 有 ModRM，低 4 位 = 立即数种类
+        constexpr uint8_t HasModRM = 0x80;
+        constexpr uint8_t Bad = 0x40;        // 64 位模式下无效（或是单独处理的前缀/转义）
+        enum : uint8_t {
+            ImmNone, ImmB, ImmW, ImmZ, ImmV, ImmMoffs, ImmEnter, ImmGroup3, RelB, RelZ
+        };
+
+        constexpr uint8_t OneByte(unsigned op) {
+            if (op < 0x40) {
+                unsigned low = op & 7;
+                if (low < 4) return HasModRM;
+                if (low == 4) return ImmB;
+                if (low == 5) return ImmZ;
+                return Bad;                  // push/pop 段寄存器、daa 等、段前缀、0F 转义
+            }
+            if (op < 0x60) return ImmNone;   // REX（单独处理）、push/pop
+            if (op >= 0x70 && op <= 0x7F) return RelB;
+            if (op >= 0x84 && op <= 0x8F) return HasModRM;
+            if (op >= 0xB0 && op <= 0xB7) return ImmB;
+            if (op >= 0xB8 && op <= 0xBF) return ImmV;
+            if (op >= 0xD8 && op <= 0xDF) return HasModRM;   // x87
+            if (op >= 0xA0 && op <= 0xA3) return ImmMoffs;
+            switch (op) {
+            case 0x63: return HasModRM;
+            case 0x68: return ImmZ;
+            case 0x69: return HasModRM | ImmZ;
+            case 0x6A: return ImmB;
+            case 0x6B: return HasModRM | ImmB;
+            case 0x6C: case 0x6D: case 0x6E: case 0x6F: return ImmNone;
+            case 0x80: return HasModRM | ImmB;
+            case 0x81: return HasModRM | ImmZ;
+            case 0x83: return HasModRM | ImmB;
+            case 0xA8: return ImmB;
+            case 0xA9: return ImmZ;
+            case 0xC0: case 0xC1: return HasModRM | ImmB;
+            case 0xC2: case 0xCA: return ImmW;
+            case 0xC6: return HasModRM | ImmB;
+            case 0xC7: return HasModRM | ImmZ;
+            case 0xC8: return ImmEnter;
+            case 0xCD: return ImmB;
+            case 0xD0: case 0xD1: case 0xD2: case 0xD3: return HasModRM;
+            case 0xE0: case 0xE1: case 0xE2: case 0xE3: return RelB;
+            case 0xE4: case 0xE5: case 0xE6: case 0xE7: return ImmB;
+            case 0xE8: case 0xE9: return RelZ;
+            case 0xEB: return RelB;
+            case 0xF6: case 0xF7: return HasModRM | ImmGroup3;
+            case 0xFE: case 0xFF: return HasModRM;
+            case 0x60: case 0x61: case 0x62: case 0x82: case 0x9A: case 0xC4: case 0xC5:
+            case 0xCE: case 0xD4: case 0xD5: case 0xD6: case 0xEA:
+            case 0x64: case 0x65: case 0x66: case 0x67: case 0xF0: case 0xF2: case 0xF3:
+                return Bad;
+            default: return ImmNone;
+            }
+        }
+
+        constexpr uint8_t TwoByte(unsigned op) {
+            if (op >= 0x80 && op <= 0x8F) return RelZ;                    // jcc rel32
+            if (op >= 0x70 && op <= 0x73) return HasModRM | ImmB;         // pshuf* / 移位组
+            if (op >= 0xC8 && op <= 0xCF) return ImmNone;                 // bswap
+            if (op >= 0x30 && op <= 0x37) return op == 0x36 ? Bad : (uint8_t)ImmNone;
+            switch (op) {
+            case 0x04: case 0x0A: case 0x0C: case 0x24: case 0x25: case 0x26: case 0x27:
+            case 0x38: case 0x39: case 0x3A: case 0x3B: case 0x3C: case 0x3D: case 0x3E: case 0x3F:
+            case 0x7A: case 0x7B: case 0xA6: case 0xA7:
+                return Bad;
+            case 0x05: case 0x06: case 0x07: case 0x08: case 0x09: case 0x0B: case 0x0E:
+            case 0x77: case 0xA0: case 0xA1: case 0xA2: case 0xA8: case 0xA9: case 0xAA:
+                return ImmNone;
+            case 0x0F: return HasModRM | ImmB;                            // 3DNow!
+            case 0xA4: case 0xAC: case 0xBA: case 0xC2: case 0xC4: case 0xC5: case 0xC6:
+                return HasModRM | ImmB;
+            default: return HasModRM;
+            }
+        }
+
+        // 编译期展开成 256 项的表
+        struct Table {
+            uint8_t value[256];
+            constexpr explicit Table(uint8_t (*f)(unsigned)) : value() {
+                for (unsigned i = 0; i < 256; i++) value[i] = f(i);
+            }
+        };
+
+        inline constexpr Table OneByteTable(OneByte);
+        inline constexpr Table TwoByteTable(TwoByte);
+
+        // VEX/EVEX 的 0F 表里带 imm8 的几条（vpshufd / vcmpps / vpinsrw / vpextrw / vshufps）
+        constexpr bool VexMap1HasImm(uint8_t op) {
+            return (op >= 0x70 && op <= 0x73) || op == 0xC2 || op == 0xC4 || op == 0xC5 || op == 0xC6;
+        }
+
+        constexpr bool IsLegacyPrefix(uint8_t b) {
+            return b == 0x66 || b == 0x67 || b == 0xF0 || b == 0xF2 || b == 0xF3 ||
+                   b == 0x2E || b == 0x36 || b == 0x3E || b == 0x26 || b == 0x64 || b == 0x65;
+        }
+    }
+
+    constexpr size_t MaxLength = 15;
+
+    /*
+     * 解码 code 处的一条 64 位模式指令，只求各部分的位置和长度
+     * 无效编码、被截断、超过 15 字节时返回 false
+     */
+    inline bool Decode(const uint8_t* code, size_t size, Instruction& out) {
+        using namespace Detail;
+        out = Instruction();
+        const size_t limit = size < MaxLength ? size : MaxLength;
+        size_t p = 0;
+        bool opsize = false, addrsize = false, rexW = false;
+
+        // 前缀；REX 只有紧贴操作码时才生效
+        while (p < limit) {
+            uint8_t b = code[p];
+            if (IsLegacyPrefix(b)) {
+                if (b == 0x66) opsize = true;
+                if (b == 0x67) addrsize = true;
+                rexW = false;
+                p++;
+            }
+            else if ((b & 0xF0) == 0x40) {
+                rexW = (b & 0x08) != 0;
+                p++;
+            }
+            else break;
+        }
+        if (p >= limit) return false;
+        out.opcodeOffset = (uint8_t)p;
+
+        uint8_t info = 0;
+        uint8_t op = code[p++];
+        bool group3 = false;
+
+        if (op == 0xC4 || op == 0xC5 || op == 0x62) {
+            // VEX(C5 两字节 / C4 三字节) / EVEX(62 四字节)：后面一定跟操作码和 ModRM
+            unsigned map = 1;
+            size_t payload = op == 0xC5 ? 1 : (op == 0xC4 ? 2 : 3);
+            if (p + payload >= limit) return false;
+            if (op == 0xC4) map = code[p] & 0x1F;
+            if (op == 0x62) map = code[p] & 0x07;
+            p += payload;
+            uint8_t vop = code[p++];
+            info = HasModRM;
+            if (op != 0x62 && map == 1 && vop == 0x77) info = ImmNone;   // vzeroupper / vzeroall 没有 ModRM
+            else if (map == 3) info |= ImmB;
+            else if (map == 1) { if (VexMap1HasImm(vop)) info |= ImmB; }
+            else if (map != 2 && !(op == 0x62 && (map == 5 || map == 6))) return false;
+        }
+        else if (op == 0x0F) {
+            if (p >= limit) return false;
+            uint8_t op2 = code[p++];
+            if (op2 == 0x38) {
+                if (p >= limit) return false;
+                p++;
+                info = HasModRM;
+            }
+            else if (op2 == 0x3A) {
+                if (p >= limit) return false;
+                p++;
+                info = HasModRM | ImmB;
+            }
+            else {
+                info = TwoByteTable.value[op2];
+                if ((info & 0x0F) == RelZ) out.branch = Branch::JumpCond;
+            }
+        }
+        else {
+            info = OneByteTable.value[op];
+            if (op == 0xE8) out.branch = Branch::Call;
+            else if (op == 0xE9 || op == 0xEB) out.branch = Branch::Jump;
+            else if ((op >= 0x70 && op <= 0x7F) || (op >= 0xE0 && op <= 0xE3)) out.branch = Branch::JumpCond;
+            group3 = (info & 0x0F) == ImmGroup3;
+        }
+        if (info & Bad) return false;
+
+        // ModRM / SIB / 位移
+        if (info & HasModRM) {
+            if (p >= limit) return false;
+            uint8_t modrm = code[p++];
+            uint8_t mod = modrm >> 6, rm = modrm & 7, reg = (modrm >> 3) & 7;
+            if (group3 && reg >= 2) group3 = false;     // F6/F7 只有 test 带立即数
+            if (mod != 3) {
+                if (rm == 4) {
+                    if (p >= limit) return false;
+                    uint8_t sib = code[p++];
+                    if (mod == 0 && (sib & 7) == 5) out.dispSize = 4;
+                }
+                else if (mod == 0 && rm == 5) {
+                    out.dispSize = 4;
+                    out.ripRelative = true;
+                }
+                if (mod == 1) out.dispSize = 1;
+                else if (mod == 2) out.dispSize = 4;
+            }
+        }
+        out.dispOffset = out.dispSize ? (uint8_t)p : 0;
+        p += out.dispSize;
+
+        // 立即数
+        uint8_t imm = 0;
+        switch (info & 0x0F) {
+        case ImmB: case RelB: imm = 1; break;
+        case ImmW: imm = 2; break;
+        case ImmZ: imm = opsize ? 2 : 4; break;
+        case ImmV: imm = rexW ? 8 : (opsize ? 2 : 4); break;
+        case ImmMoffs: imm = addrsize ? 4 : 8; break;
+        case ImmEnter: imm = 3; break;
+        case ImmGroup3: imm = group3 ? (op == 0xF6 ? 1 : (opsize ? 2 : 4)) : 0; break;
+        case RelZ: imm = 4; break;
+        default: break;
+        }
+        out.immOffset = imm ? (uint8_t)p : 0;
+        out.immSize = imm;
+        p += imm;
+
+        if (p > limit) return false;
+        out.length = (uint8_t)p;
+        return true;
+    }
+}
+
+// ====================================
+// 第二部分：引用索引
+// ====================================
+
+namespace PatternEngine {
+
+    enum class RefKind : uint8_t {
+        Data,           // RIP 相对内存操作数（读写全局变量、lea 取地址）
+        Call,           // call rel32
+        Jump,           // jmp rel32
+        JumpCond        // jcc rel32
+    };
+
+    struct CodeRef {
+        uint64_t from = 0;          // 引用指令的地址
+        uint64_t target = 0;        // 被引用的地址
+        RefKind kind = RefKind::Data;
+        uint8_t length = 0;         // 指令长度
+        uint8_t operandOffset = 0;  // disp32/rel32 在指令中的位置
+    };
+
+    struct XrefOptions {
+        size_t chunkSize = 1 << 20;     // 并行线性扫描的块大小（结果和块大小无关，块太小只是拼接时重解码多）
+        unsigned threads = 0;
+    };
+
+    class XrefIndex {
+    public:
+        /*
+         * 对一段代码做线性扫描，引用加入索引（调用 Finalize 之后才能查询）
+         * code 对应的运行时地址是 address；目标不在 [targetLow, targetHigh) 内的引用丢掉
+         */
+        void AddCode(const uint8_t* code, size_t size, uint64_t address,
+                     uint64_t targetLow = 0, uint64_t targetHigh = ~0ULL, const XrefOptions& options = XrefOptions()) {
+            size_t chunkSize = options.chunkSize ? options.chunkSize : size;
+            size_t chunks = size ? (size + chunkSize - 1) / chunkSize : 0;
+            std::vector<ChunkScan> scans(chunks);
+
+            // 并行：每块从自己的起点猜着解码，记下每条指令的起点，解码到跨过块尾为止
+            ChunkStealingPool::Run(chunks, options.threads, [&](size_t c) {
+                size_t begin = c * chunkSize;
+                size_t end = begin + chunkSize < size ? begin + chunkSize : size;
+                scans[c].exit = Sweep(code, size, address, begin, end, targetLow, targetHigh, scans[c]);
+            });
+
+            /*
+             * 拼接：上一块（已确认正确）跨过块尾后的第一条指令起点 entry，
+             * 就是顺序扫描在这一块里的第一条指令。猜的解码流里也有 entry 这个起点时，
+             * 从 entry 往后两条流完全相同，只要丢掉 entry 之前的；
+             * 没有（块太小、整块都没对齐）就从 entry 重新解码这一块
+             */
+            size_t entry = 0;
+            for (size_t c = 0; c < chunks; c++) {
+                ChunkScan& scan = scans[c];
+                size_t begin = c * chunkSize;
+                size_t end = begin + chunkSize < size ? begin + chunkSize : size;
+                if (entry >= end) {
+                    continue;       // 上一块的最后一条指令盖住了整块
+                }
+                if (!scan.IsStart(entry - begin)) {
+                    scan = ChunkScan();
+                    scan.exit = Sweep(code, size, address, entry, end, targetLow, targetHigh, scan);
+                    begin = entry;
+                }
+                uint64_t skipped = 0;
+                for (size_t pos = begin; pos < entry; pos++) skipped += scan.IsStart(pos - begin);
+                size_t first = 0;
+                while (first < scan.refs.size() && scan.refs[first].from < address + entry) first++;
+
+                refs.insert(refs.end(), scan.refs.begin() + first, scan.refs.end());
+                instructions += scan.decoded - skipped;
+                entry = scan.exit;
+            }
+            finalized = false;
+        }
+
+        /*
+         * 整个镜像的可执行区段（文件布局或内存布局），目标限定在镜像范围内
+         * moduleBase：运行时模块基址（离线分析时用 image.imageBase，ELF 为 0）
+         */
+        void AddImage(const uint8_t* data, size_t size, const ImageFormat::ImageLayout& image,
+                      ImageFormat::Layout layout, uint64_t moduleBase, const XrefOptions& options = XrefOptions()) {
+            uint64_t imageEnd = 0;
+            for (const auto& section : image.sections) {
+                uint64_t end = section.virtualAddress + section.virtualSize;
+                if (end > imageEnd) imageEnd = end;
+            }
+            for (const auto& section : image.sections) {
+                if (!section.executable) continue;
+                uint64_t begin = layout == ImageFormat::Layout::File ? section.fileOffset : section.virtualAddress;
+                uint64_t length = layout == ImageFormat::Layout::File ? section.fileSize : section.virtualSize;
+                if (length == 0 || begin >= size) continue;
+                if (length > size - begin) length = size - begin;
+                AddCode(data + begin, (size_t)length, moduleBase + section.virtualAddress,
+                        moduleBase, moduleBase + imageEnd, options);
+            }
+            Finalize();
+        }
+
+        // 按目标排序并建哈希索引
+        void Finalize() {
+            std::sort(refs.begin(), refs.end(), [](const CodeRef& a, const CodeRef& b) {
+                return a.target != b.target ? a.target < b.target : a.from < b.from;
+            });
+            lookup.clear();
+            lookup.reserve(refs.size() / 2 + 1);
+            for (size_t i = 0; i < refs.size(); ) {
+                size_t j = i;
+                while (j < refs.size() && refs[j].target == refs[i].target) j++;
+                lookup.emplace(refs[i].target, Span{ (uint32_t)i, (uint32_t)(j - i) });
+                i = j;
+            }
+            finalized = true;
+        }
+
+        // 引用 target 的所有指令（按指令地址升序）
+        const CodeRef* References(uint64_t target, size_t& count) const {
+            auto it = lookup.find(target);
+            if (it == lookup.end()) {
+                count = 0;
+                return nullptr;
+            }
+            count = it->second.count;
+            return refs.data() + it->second.first;
+        }
+
+        std::vector<CodeRef> References(uint64_t target) const {
+            size_t count;
+            const CodeRef* first = References(target, count);
+            return first ? std::vector<CodeRef>(first, first + count) : std::vector<CodeRef>();
+        }
+
+        // 引用 [low, high) 内任意地址的指令（比如某个全局结构体的所有字段）
+        template<typename Fn>
+        void ForEachInRange(uint64_t low, uint64_t high, Fn fn) const {
+            auto it = std::lower_bound(refs.begin(), refs.end(), low, [](const CodeRef& r, uint64_t value) {
+                return r.target < value;
+            });
+            for (; it != refs.end() && it->target < high; ++it) fn(*it);
+        }
+
+        size_t Count() const { return refs.size(); }
+        size_t Targets() const { return lookup.size(); }
+        uint64_t InstructionCount() const { return instructions; }
+        bool Finalized() const { return finalized; }
+
+        void Clear() {
+            refs.clear();
+            lookup.clear();
+            instructions = 0;
+            finalized = false;
+        }
+
+    private:
+        struct Span {
+            uint32_t first;
+            uint32_t count;
+        };
+
+        // 一块的解码结果；starts 按位记录哪些偏移（相对解码起点）是指令起点
+        struct ChunkScan {
+            std::vector<CodeRef> refs;
+            std::vector<uint64_t> starts;
+            uint64_t decoded = 0;
+            size_t exit = 0;            // 跨过块尾后的第一条指令起点
+
+            bool IsStart(size_t offset) const {
+                return offset / 64 < starts.size() && (starts[offset / 64] >> (offset % 64) & 1);
+            }
+        };
+
+        // 从 begin 线性解码到跨过 end，返回停下的位置
+        static size_t Sweep(const uint8_t* code, size_t size, uint64_t address, size_t begin, size_t end,
+                            uint64_t low, uint64_t high, ChunkScan& scan) {
+            scan.starts.assign((end - begin + 63) / 64, 0);
+            size_t pos = begin;
+            X64::Instruction ins;
+            while (pos < end) {
+                if (!X64::Decode(code + pos, size - pos, ins)) {
+                    pos++;      // 无效字节：跳过一个字节重新同步
+                    continue;
+                }
+                scan.starts[(pos - begin) / 64] |= 1ULL << ((pos - begin) % 64);
+                scan.decoded++;
+                Record(code + pos, address + pos, ins, low, high, scan.refs);
+                pos += ins.length;
+            }
+            return pos;
+        }
+
+        static void Record(const uint8_t* code, uint64_t address, const X64::Instruction& ins,
+                           uint64_t low, uint64_t high, std::vector<CodeRef>& out) {
+            CodeRef ref;
+            ref.from = address;
+            ref.length = ins.length;
+            if (ins.ripRelative) {
+                ref.kind = RefKind::Data;
+                ref.target = ins.RipTarget(address, code);
+                ref.operandOffset = ins.dispOffset;
+            }
+            else if (ins.branch != X64::Branch::None && ins.immSize == 4) {
+                ref.kind = ins.branch == X64::Branch::Call ? RefKind::Call :
+                           ins.branch == X64::Branch::Jump ? RefKind::Jump : RefKind::JumpCond;
+                ref.target = ins.BranchTarget(address, code);
+                ref.operandOffset = ins.immOffset;
+            }
+            else return;
+            if (ref.target >= low && ref.target < high) out.push_back(ref);
+        }
+
+        std::vector<CodeRef> refs;      // 按 (target, from) 排序
+        std::unordered_map<uint64_t, Span> lookup;
+        uint64_t instructions = 0;
+        bool finalized = false;
+    };
+}
@@ -0,0 +1,366 @@
+/*
+ * ========================================
+ * 第四课补充：再次扫描（Next Scan）
+ * ========================================
+ *
+ * PrintCETasks 里的流程：首次扫描 -> 等数值变化 -> 再次扫描 -> 重复直到只剩 1-2 个地址。
+ * 再次扫描的条件：新值、变动的值、未变动的值、增加的值、减少的值。
+ *
+ * 首次扫描可能命中上亿个地址，候选集合的存法决定了内存占用：
+ * - 稠密时：位图（每个候选位置 1 bit），配合"上次的值"数组
+ * - 稀疏时：有序地址的差分编码（相邻地址的间隔用变长整数存，通常 1-2 字节）
+ * 每次过滤后根据剩余数量自动切换。
+ *
+ * 每次再次扫描只读取幸存候选处的内存，并按块多线程过滤。
+ */
+
+#pragma once
+#include "ValueScan.h"
+
+namespace ValueScan {
+
+    // ====================================
+    // 第一部分：再次扫描条件
+    // ====================================
+
+    enum class NextScanType {
+        Value,      // 新值满足 Condition（精确值/范围/误差）
+        Changed,    // 变动的值
+        Unchanged,  // 未变动的值
+        Increased,  // 增加的值
+        Decreased   // 减少的值
+    };
+
+    template<typename T>
+    struct NextCondition {
+        NextScanType type = NextScanType::Changed;
+        Condition<T> value;
+
+        static NextCondition Of(NextScanType t) {
+            NextCondition c;
+            c.type = t;
+            return c;
+        }
+
+        static NextCondition Matching(const Condition<T>& cond) {
+            NextCondition c;
+            c.type = NextScanType::Value;
+            c.value = cond.Normalized();
+            return c;
+        }
+
+        bool Test(T current, T previous) const {
+            switch (type) {
+                case NextScanType::Value:     return value.Test(current);
+                case NextScanType::Changed:   return memcmp(&current, &previous, sizeof(T)) != 0;
+                case NextScanType::Unchanged: return memcmp(&current, &previous, sizeof(T)) == 0;
+                case NextScanType::Increased: return current > previous;
+                case NextScanType::Decreased: return current < previous;
+            }
+            return false;
+        }
+    };
+
+    // ====================================
+    // 第二部分：差分编码的地址列表
+    // ====================================
+
+    /*
+     * 候选位置按升序分块存放，每块最多 BlockEntries 个：
+     *   块头记录第一个位置、在字节流中的起点、数量、对应的"上次值"下标
+     *   块内其余位置存与前一个位置的间隔（LEB128 变长整数）
+     * 块之间互不依赖，可以并行解码
+     */
+    struct DeltaBlock {
+        uint64_t firstPosition = 0;
+        uint64_t byteOffset = 0;
+        uint64_t valueStart = 0;
+        uint32_t count = 0;
+    };
+
+    inline void WriteVarint(std::vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((uint8_t)v);
+    }
+
+    inline uint64_t ReadVarint(const uint8_t*& p) {
+        uint64_t v = 0;
+        int shift = 0;
+        while (*p & 0x80) {
+            v |= (uint64_t)(*p++ & 0x7F) << shift;
+            shift += 7;
+        }
+        v |= (uint64_t)(*p++) << shift;
+        return v;
+    }
+
+    inline size_t VarintSize(uint64_t v) {
+        size_t n = 1;
+        while (v >= 0x80) {
+            v >>= 7;
+            n++;
+        }
+        return n;
+    }
+
+    class DeltaList {
+    public:
+        static constexpr uint32_t BlockEntries = 1024;
+
+        void Append(uint64_t position) {
+            if (blocks.empty() || blocks.back().count == BlockEntries) {
+                DeltaBlock block;
+                block.firstPosition = position;
+                block.byteOffset = stream.size();
+                block.valueStart = total;
+                blocks.push_back(block);
+            }
+            else {
+                WriteVarint(stream, position - last);
+            }
+            blocks.back().count++;
+            last = position;
+            total++;
+        }
+
+        // 把另一段（位置更大的）列表接在后面
+        void Concat(const DeltaList& other) {
+            for (DeltaBlock block : other.blocks) {
+                block.byteOffset += stream.size();
+                block.valueStart += total;
+                blocks.push_back(block);
+            }
+            stream.insert(stream.end(), other.stream.begin(), other.stream.end());
+            total += other.total;
+            if (other.total) last = other.last;
+        }
+
+        // 依次给出块 b 中的每个位置
+        template<typename Fn>
+        void ForEachInBlock(size_t b, Fn fn) const {
+            const DeltaBlock& block = blocks[b];
+            const uint8_t* p = stream.data() + block.byteOffset;
+            uint64_t position = block.firstPosition;
+            for (uint32_t i = 0; i < block.count; i++) {
+                if (i) position += ReadVarint(p);
+                fn(position);
+            }
+        }
+
+        const std::vector<DeltaBlock>& Blocks() const { return blocks; }
+        size_t Count() const { return total; }
+        size_t MemoryBytes() const { return stream.capacity() + blocks.capacity() * sizeof(DeltaBlock); }
+
+        void Clear() {
+            blocks.clear();
+            stream.clear();
+            total = 0;
+            last = 0;
+        }
+
+    private:
+        std::vector<DeltaBlock> blocks;
+        std::vector<uint8_t> stream;
+        uint64_t total = 0;
+        uint64_t last = 0;
+    };
+
+    // ====================================
+    // 第三部分：候选集合
+    // ====================================
+
+    template<typename T>
+    class CandidateSet {
+    public:
+        enum class Encoding { Bitmap, DeltaList };
+
+        static constexpr size_t ChunkWords = 4096;       // 位图每个任务处理 4096 个字（26 万个位置）
+        static constexpr size_t ChunkBlocks = 64;        // 差分列表每个任务处理 64 块
+
+        /*
+         * 从首次扫描的结果建立候选集合：记下每个命中处的当前值
+         * data 必须是首次扫描时的同一段内存
+         */
+        static CandidateSet FromFirstScan(const uint8_t* data, HitBitmap hits, unsigned threads = 0) {
+            CandidateSet set;
+            set.stride = hits.Stride();
+            set.bitmap = std::move(hits);
+
+            std::vector<uint64_t> ranks = set.ChunkRanks();
+            set.count = ranks.back();
+            set.values.resize(set.count);
+
+            const std::vector<uint64_t>& words = set.bitmap.Words();
+            PatternEngine::ChunkStealingPool::Run(ranks.size() - 1, threads, [&](size_t c) {
+                uint64_t rank = ranks[c];
+                size_t wEnd = (c + 1) * ChunkWords < words.size() ? (c + 1) * ChunkWords : words.size();
+                for (size_t w = c * ChunkWords; w < wEnd; w++) {
+                    for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+                        size_t k = w * 64 + HitBitmap::CountTrailingZeros64(bits);
+                        set.values[rank++] = LoadValue<T>(data + k * set.stride);
+                    }
+                }
+            });
+            set.Compact();
+            return set;
+        }
+
+        /*
+         * 再次扫描：只读取幸存候选处的值，满足条件的留下并更新"上次的值"
+         * data/size 是同一段内存的当前内容（同一基址）
+         */
+        void Next(const uint8_t* data, size_t size, const NextCondition<T>& condition, unsigned threads = 0) {
+            if (encoding == Encoding::Bitmap) FilterBitmap(data, size, condition, threads);
+            else FilterDeltaList(data, size, condition, threads);
+            Compact();
+        }
+
+        // 依次给出每个候选的偏移和上次的值
+        template<typename Fn>
+        void ForEach(Fn fn) const {
+            uint64_t rank = 0;
+            if (encoding == Encoding::Bitmap) {
+                bitmap.ForEach([&](size_t offset) { fn(offset, values[rank++]); });
+                return;
+            }
+            for (size_t b = 0; b < deltas.Blocks().size(); b++) {
+                deltas.ForEachInBlock(b, [&](uint64_t k) { fn((size_t)(k * stride), values[rank++]); });
+            }
+        }
+
+        size_t Count() const { return count; }
+        size_t Stride() const { return stride; }
+        Encoding GetEncoding() const { return encoding; }
+
+        // 地址部分 + 上次值部分占用的字节数
+        size_t MemoryBytes() const {
+            size_t addresses = encoding == Encoding::Bitmap ? bitmap.Words().size() * sizeof(uint64_t) : deltas.MemoryBytes();
+            return addresses + values.capacity() * sizeof(T);
+        }
+
+    private:
+        // 每个位图块之前的命中数（前缀和），最后一项是总数
+        std::vector<uint64_t> ChunkRanks() const {
+            const std::vector<uint64_t>& words = bitmap.Words();
+            size_t chunks = (words.size() + ChunkWords - 1) / ChunkWords;
+            std::vector<uint64_t> ranks(chunks + 1, 0);
+            for (size_t c = 0; c < chunks; c++) {
+                uint64_t n = 0;
+                size_t wEnd = (c + 1) * ChunkWords < words.size() ? (c + 1) * ChunkWords : words.size();
+                for (size_t w = c * ChunkWords; w < wEnd; w++) n += HitBitmap::PopCount(words[w]);
+                ranks[c + 1] = ranks[c] + n;
+            }
+            return ranks;
+        }
+
+        // 候选位置 k 处的值是否完整落在当前内存内
+        bool InRange(uint64_t k, size_t size) const {
+            return k * stride <= size && size - k * stride >= sizeof(T);
+        }
+
+        void FilterBitmap(const uint8_t* data, size_t size, const NextCondition<T>& condition, unsigned threads) {
+            std::vector<uint64_t> ranks = ChunkRanks();
+            std::vector<uint64_t>& words = bitmap.Words();
+            std::vector<std::vector<T>> kept(ranks.size() - 1);
+
+            // 每个任务只改写自己那段位图字，互不干扰
+            PatternEngine::ChunkStealingPool::Run(ranks.size() - 1, threads, [&](size_t c) {
+                uint64_t rank = ranks[c];
+                std::vector<T>& out = kept[c];
+                size_t wEnd = (c + 1) * ChunkWords < words.size() ? (c + 1) * ChunkWords : words.size();
+                for (size_t w = c * ChunkWords; w < wEnd; w++) {
+                    uint64_t survivors = 0;
+                    for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+                        unsigned bit = HitBitmap::CountTrailingZeros64(bits);
+                        uint64_t k = w * 64 + bit;
+                        T previous = values[rank++];
+                        if (!InRange(k, size)) continue;
+                        T current = LoadValue<T>(data + k * stride);
+                        if (condition.Test(current, previous)) {
+                            survivors |= 1ULL << bit;
+                            out.push_back(current);
+                        }
+                    }
+                    words[w] = survivors;
+                }
+            });
+
+            Gather(kept);
+        }
+
+        void FilterDeltaList(const uint8_t* data, size_t size, const NextCondition<T>& condition, unsigned threads) {
+            const std::vector<DeltaBlock>& blocks = deltas.Blocks();
+            size_t chunks = (blocks.size() + ChunkBlocks - 1) / ChunkBlocks;
+            std::vector<DeltaList> lists(chunks);
+            std::vector<std::vector<T>> kept(chunks);
+
+            PatternEngine::ChunkStealingPool::Run(chunks, threads, [&](size_t c) {
+                size_t bEnd = (c + 1) * ChunkBlocks < blocks.size() ? (c + 1) * ChunkBlocks : blocks.size();
+                for (size_t b = c * ChunkBlocks; b < bEnd; b++) {
+                    uint64_t rank = blocks[b].valueStart;
+                    deltas.ForEachInBlock(b, [&](uint64_t k) {
+                        T previous = values[rank++];
+                        if (!InRange(k, size)) return;
+                        T current = LoadValue<T>(data + k * stride);
+                        if (condition.Test(current, previous)) {
+                            lists[c].Append(k);
+                            kept[c].push_back(current);
+                        }
+                    });
+                }
+            });
+
+            DeltaList merged;
+            for (const DeltaList& list : lists) merged.Concat(list);
+            deltas = std::move(merged);
+            Gather(kept);
+        }
+
+        // 按块顺序拼接幸存者的新值
+        void Gather(std::vector<std::vector<T>>& kept) {
+            size_t total = 0;
+            for (const auto& part : kept) total += part.size();
+            std::vector<T> merged;
+            merged.reserve(total);
+            for (auto& part : kept) {
+                merged.insert(merged.end(), part.begin(), part.end());
+                std::vector<T>().swap(part);
+            }
+            values = std::move(merged);
+            count = total;
+        }
+
+        /*
+         * 稀疏时改用差分列表：
+         * 估算每个候选的平均间隔需要几个字节，比位图小一半以上才切换（避免来回抖动）
+         * 集合只会越扫越小，所以不需要再从差分列表切回位图
+         */
+        void Compact() {
+            if (encoding != Encoding::Bitmap) return;
+            size_t bitmapBytes = bitmap.Words().size() * sizeof(uint64_t);
+            size_t estimate = count == 0 ? 0 : count * VarintSize(bitmap.Positions() / count);
+            if (estimate * 2 >= bitmapBytes) return;
+
+            DeltaList list;
+            const std::vector<uint64_t>& words = bitmap.Words();
+            for (size_t w = 0; w < words.size(); w++) {
+                for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+                    list.Append(w * 64 + HitBitmap::CountTrailingZeros64(bits));
+                }
+            }
+            deltas = std::move(list);
+            bitmap = HitBitmap();
+            encoding = Encoding::DeltaList;
+        }
+
+        Encoding encoding = Encoding::Bitmap;
+        size_t stride = sizeof(T);
+        size_t count = 0;
+        HitBitmap bitmap;
+        DeltaList deltas;
+        std::vector<T> values;   // 第 i 个候选的上次值
+    };
+}
@@ -0,0 +1,478 @@
+/*
+ * ========================================
+ * 第四课补充：内存页快照
+ * ========================================
+ *
+ * "未知初始值"扫描的第一步是把整个进程的可读内存拍一张快照，
+ * 之后每次再次扫描都和上一张快照比较。直接拷贝整个地址空间太浪费：
+ *
+ * 1. 按 4KB 页保存，每页记一个 XXH64 哈希
+ * 2. 页内容压缩保存（全零页不占空间，其它页用 LZ4 风格的简单压缩）
+ * 3. 写时复制：新快照里哈希没变的页直接共用旧快照的压缩数据，
+ *    只有变化的页才重新压缩 —— 多张快照的内存开销只和"变化的数据量"有关
+ *
+ * 数据来源：
+ * - 进程（默认是自己，也可以是 04-CheatEngine 练习程序的 PID）
+ *   Windows: VirtualQueryEx + ReadProcessMemory
+ *   Linux:   /proc/<pid>/maps + process_vm_readv
+ * - 内存 dump 文件（用 MappedFile 映射后当作一段内存）
+ */
+
+#pragma once
+#include "../03-ReverseTools/FastHash.h"
+#include "../03-ReverseTools/ParallelScan.h"
+#include <cstdio>
+#include <string>
+#include <memory>
+#include <functional>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>      // K32GetMappedFileNameA（kernel32 导出，不需要链接 psapi.lib）
+#else
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace Snapshot {
+
+    constexpr size_t PageSize = 4096;
+
+    // ====================================
+    // 第一部分：内存区域与读取
+    // ====================================
+
+    struct MemoryRegion {
+        uint64_t base = 0;
+        uint64_t size = 0;
+        bool writable = false;
+        bool executable = false;
+        bool image = false;         // 属于某个模块（exe/dll/so）—— 指针扫描的"静态基址"
+        uint64_t moduleBase = 0;    // 所属模块的基址
+        std::string name;           // 模块文件名 / Linux 下的 [heap]、[stack]
+    };
+
+    // 读取 [address, address + size)，失败（页面已释放、无权限）返回 false
+    using MemoryReader = std::function<bool(uint64_t address, void* dest, size_t size)>;
+
+    /*
+     * 枚举进程的可读区域（pid 为 0 表示当前进程）
+     */
+    inline std::vector<MemoryRegion> EnumerateRegions(uint32_t pid = 0) {
+        std::vector<MemoryRegion> regions;
+#ifdef _WIN32
+        HANDLE process = pid ? OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid) : GetCurrentProcess();
+        if (!process) return regions;
+
+        MEMORY_BASIC_INFORMATION mbi;
+        uint8_t* address = nullptr;
+        while (VirtualQueryEx(process, address, &mbi, sizeof(mbi)) == sizeof(mbi)) {
+            DWORD protect = mbi.Protect & 0xFF;
+            bool readable = mbi.State == MEM_COMMIT && !(mbi.Protect & PAGE_GUARD)
+                         && protect != PAGE_NOACCESS && protect != 0;
+            if (readable) {
+                MemoryRegion region;
+                region.base = (uint64_t)(uintptr_t)mbi.BaseAddress;
+                region.size = mbi.RegionSize;
+                region.writable = (protect & (PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+                region.executable = (protect & (PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+                if (mbi.Type == MEM_IMAGE) {
+                    char path[MAX_PATH] = {};
+                    region.image = true;
+                    region.moduleBase = (uint64_t)(uintptr_t)mbi.AllocationBase;
+                    if (K32GetMappedFileNameA(process, mbi.AllocationBase, path, MAX_PATH)) region.name = path;
+                }
+                regions.push_back(region);
+            }
+            address = (uint8_t*)mbi.BaseAddress + mbi.RegionSize;
+        }
+        if (pid) CloseHandle(process);
+#else
+        std::string path = pid ? "/proc/" + std::to_string(pid) + "/maps" : "/proc/self/maps";
+        FILE* maps = fopen(path.c_str(), "r");
+        if (!maps) return regions;
+
+        char line[4096];
+        while (fgets(line, sizeof(line), maps)) {
+            unsigned long long begin = 0, end = 0;
+            char perms[8] = {};
+            int nameStart = 0;
+            if (sscanf(line, "%llx-%llx %7s %*s %*s %*s %n", &begin, &end, perms, &nameStart) < 3) continue;
+            if (perms[0] != 'r') continue;
+
+            std::string name = nameStart > 0 ? line + nameStart : "";
+            while (!name.empty() && (name.back() == '\n' || name.back() == ' ')) name.pop_back();
+            // 这些特殊映射读了也没意义（或者读不了）
+            if (name == "[vvar]" || name == "[vvar_vclock]" || name == "[vsyscall]") continue;
+
+            MemoryRegion region;
+            region.base = begin;
+            region.size = end - begin;
+            region.writable = perms[1] == 'w';
+            region.executable = perms[2] == 'x';
+            region.name = name;
+
+            // 文件映射 = 模块；模块基址取同名映射中地址最低的那个
+            if (!name.empty() && name[0] == '/') {
+                region.image = true;
+                region.moduleBase = begin;
+                for (const MemoryRegion& other : regions) {
+                    if (other.image && other.name == name) {
+                        region.moduleBase = other.moduleBase;
+                        break;
+                    }
+                }
+            }
+            // .bss 是紧跟在模块数据段后面的匿名映射，全局变量（例如 g_Engine）就在这里
+            else if (name.empty() && !regions.empty()) {
+                const MemoryRegion& previous = regions.back();
+                if (previous.image && previous.writable && previous.base + previous.size == begin) {
+                    region.image = true;
+                    region.moduleBase = previous.moduleBase;
+                    region.name = previous.name;
+                }
+            }
+            regions.push_back(region);
+        }
+        fclose(maps);
+#endif
+        return regions;
+    }
+
+    // 进程内存读取器（pid 为 0 表示当前进程）
+    inline MemoryReader ProcessReader(uint32_t pid = 0) {
+#ifdef _WIN32
+        HANDLE process = pid ? OpenProcess(PROCESS_VM_READ, FALSE, pid) : GetCurrentProcess();
+        std::shared_ptr<void> handle(process, [pid](HANDLE h) { if (pid && h) CloseHandle(h); });
+        return [handle](uint64_t address, void* dest, size_t size) {
+            SIZE_T read = 0;
+            return handle.get() && ReadProcessMemory(handle.get(), (LPCVOID)(uintptr_t)address, dest, size, &read) && read == size;
+        };
+#else
+        pid_t target = pid ? (pid_t)pid : getpid();
+        return [target](uint64_t address, void* dest, size_t size) {
+            // 读自己也走系统调用：页面被释放时返回错误而不是崩溃
+            struct iovec local = { dest, size };
+            struct iovec remote = { (void*)(uintptr_t)address, size };
+            return process_vm_readv(target, &local, 1, &remote, 1, 0) == (ssize_t)size;
+        };
+#endif
+    }
+
+    // 内存 dump / 已映射文件：把 data 当作从 base 开始的一段内存
+    inline MemoryReader BufferReader(const uint8_t* data, size_t size, uint64_t base = 0) {
+        return [data, size, base](uint64_t address, void* dest, size_t length) {
+            if (address < base || address - base > size || size - (address - base) < length) return false;
+            memcpy(dest, data + (address - base), length);
+            return true;
+        };
+    }
+
+    // ====================================
+    // 第二部分：页压缩（LZ4 风格）
+    // ====================================
+
+    /*
+     * 序列格式：token | [额外字面量长度] | 字面量 | 偏移 u16 | [额外匹配长度]
+     *   token 高 4 位 = 字面量长度，低 4 位 = 匹配长度 - 4，满 15 时后面追加 255 串
+     *   最后一个序列只有字面量
+     * 内存页里大量是 0、重复的指针和填充，简单的 LZ 就能压到原来的几分之一
+     */
+    namespace PageCodec {
+
+        constexpr size_t MinMatch = 4;
+        constexpr int HashBits = 12;
+
+        inline uint32_t Read32(const uint8_t* p) {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline void WriteLength(std::vector<uint8_t>& out, size_t length) {
+            while (length >= 255) {
+                out.push_back(255);
+                length -= 255;
+            }
+            out.push_back((uint8_t)length);
+        }
+
+        inline void EmitSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalLength,
+                                 size_t offset, size_t matchLength) {
+            size_t extraMatch = matchLength ? matchLength - MinMatch : 0;
+            uint8_t token = (uint8_t)(((literalLength < 15 ? literalLength : 15) << 4) | (extraMatch < 15 ? extraMatch : 15));
+            out.push_back(token);
+            if (literalLength >= 15) WriteLength(out, literalLength - 15);
+            out.insert(out.end(), literals, literals + literalLength);
+            if (!matchLength) return;
+            out.push_back((uint8_t)offset);
+            out.push_back((uint8_t)(offset >> 8));
+            if (extraMatch >= 15) WriteLength(out, extraMatch - 15);
+        }
+
+        // 压缩一页（size 不超过 64KB）
+        inline void Compress(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+            out.clear();
+            int32_t table[1 << HashBits];
+            for (int32_t& slot : table) slot = -1;
+
+            size_t anchor = 0;
+            size_t i = 0;
+            while (i + MinMatch <= size) {
+                uint32_t sequence = Read32(src + i);
+                uint32_t h = (sequence * 2654435761u) >> (32 - HashBits);
+                int32_t candidate = table[h];
+                table[h] = (int32_t)i;
+
+                if (candidate < 0 || i - (size_t)candidate > 0xFFFF || Read32(src + candidate) != sequence) {
+                    i++;
+                    continue;
+                }
+                size_t length = MinMatch;
+                while (i + length < size && src[candidate + length] == src[i + length]) length++;
+
+                EmitSequence(out, src + anchor, i - anchor, i - (size_t)candidate, length);
+                i += length;
+                anchor = i;
+            }
+            EmitSequence(out, src + anchor, size - anchor, 0, 0);
+        }
+
+        inline bool ReadLength(const uint8_t*& p, const uint8_t* end, size_t& length) {
+            uint8_t b;
+            do {
+                if (p >= end) return false;
+                b = *p++;
+                length += b;
+            } while (b == 255);
+            return true;
+        }
+
+        // 解压到 dest（正好 size 字节），数据损坏返回 false
+        inline bool Decompress(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t size) {
+            const uint8_t* p = src;
+            const uint8_t* end = src + srcSize;
+            size_t o = 0;
+            while (p < end) {
+                uint8_t token = *p++;
+                size_t literalLength = token >> 4;
+                if (literalLength == 15 && !ReadLength(p, end, literalLength)) return false;
+                if ((size_t)(end - p) < literalLength || size - o < literalLength) return false;
+                memcpy(dest + o, p, literalLength);
+                p += literalLength;
+                o += literalLength;
+                if (p == end) break;  // 最后一个序列
+
+                if (end - p < 2) return false;
+                size_t offset = p[0] | ((size_t)p[1] << 8);
+                p += 2;
+                size_t matchLength = token & 15;
+                if (matchLength == 15 && !ReadLength(p, end, matchLength)) return false;
+                matchLength += MinMatch;
+                if (offset == 0 || offset > o || size - o < matchLength) return false;
+                for (size_t j = 0; j < matchLength; j++, o++) dest[o] = dest[o - offset];  // 可能重叠，逐字节复制
+            }
+            return o == size;
+        }
+    }
+
+    // ====================================
+    // 第三部分：快照
+    // ====================================
+
+    enum class PageEncoding : uint8_t {
+        Zero,       // 全零页，不存数据
+        Compressed, // PageCodec 压缩
+        Raw         // 压缩后反而更大，原样保存
+    };
+
+    struct SnapshotPage {
+        uint64_t address = 0;
+        uint64_t hash = 0;
+        PageEncoding encoding = PageEncoding::Zero;
+        std::shared_ptr<const std::vector<uint8_t>> blob;   // 多张快照共用
+
+        // 解压到 out（PageSize 字节）
+        bool Read(uint8_t* out) const {
+            switch (encoding) {
+                case PageEncoding::Zero:
+                    memset(out, 0, PageSize);
+                    return true;
+                case PageEncoding::Raw:
+                    memcpy(out, blob->data(), PageSize);
+                    return true;
+                default:
+                    return PageCodec::Decompress(blob->data(), blob->size(), out, PageSize);
+            }
+        }
+    };
+
+    struct CaptureStats {
+        size_t pages = 0;
+        size_t sharedPages = 0;      // 与上一张快照共用的页
+        size_t zeroPages = 0;
+        size_t unreadablePages = 0;  // 枚举之后被释放或改了权限的页
+    };
+
+    class PageSnapshot {
+    public:
+        /*
+         * 拍快照：逐页读取、哈希、压缩
+         * previous 不为空时，哈希相同的页直接共用上一张快照的数据（写时复制）
+         */
+        static PageSnapshot Capture(const MemoryReader& reader, const std::vector<MemoryRegion>& regions,
+                                    const PageSnapshot* previous = nullptr, CaptureStats* stats = nullptr,
+                                    unsigned threads = 0) {
+            PageSnapshot snapshot;
+            snapshot.regions = regions;
+            // 区域按地址升序（VirtualQueryEx 和 /proc/<pid>/maps 都是升序），相邻区域可能共用一页
+            std::vector<uint64_t> addresses;
+            for (const MemoryRegion& region : regions) {
+                uint64_t begin = region.base / PageSize * PageSize;
+                for (uint64_t page = begin; page < region.base + region.size; page += PageSize) {
+                    if (addresses.empty() || page > addresses.back()) addresses.push_back(page);
+                }
+            }
+
+            std::vector<SnapshotPage> pages(addresses.size());
+            std::vector<uint8_t> readable(addresses.size(), 0);
+            std::vector<uint8_t> shared(addresses.size(), 0);
+            const size_t pagesPerChunk = 64;
+            size_t chunks = (addresses.size() + pagesPerChunk - 1) / pagesPerChunk;
+
+            PatternEngine::ChunkStealingPool::Run(chunks, threads, [&](size_t c) {
+                std::vector<uint8_t> buffer(PageSize);
+                std::vector<uint8_t> compressed;
+                size_t end = (c + 1) * pagesPerChunk < addresses.size() ? (c + 1) * pagesPerChunk : addresses.size();
+                for (size_t i = c * pagesPerChunk; i < end; i++) {
+                    SnapshotPage& page = pages[i];
+                    page.address = addresses[i];
+                    if (!reader(page.address, buffer.data(), PageSize)) continue;
+                    readable[i] = 1;
+                    page.hash = FastHash::XXH64(buffer.data(), PageSize);
+
+                    const SnapshotPage* old = previous ? previous->Find(page.address) : nullptr;
+                    if (old && old->hash == page.hash) {
+                        page.encoding = old->encoding;
+                        page.blob = old->blob;
+                        shared[i] = 1;
+                        continue;
+                    }
+                    Encode(buffer.data(), compressed, page);
+                }
+            });
+
+            // 去掉读取失败的页
+            CaptureStats local;
+            for (size_t i = 0; i < pages.size(); i++) {
+                if (!readable[i]) {
+                    local.unreadablePages++;
+                    continue;
+                }
+                local.sharedPages += shared[i];
+                local.zeroPages += pages[i].encoding == PageEncoding::Zero;
+                snapshot.pages.push_back(std::move(pages[i]));
+            }
+            local.pages = snapshot.pages.size();
+            if (stats) *stats = local;
+            return snapshot;
+        }
+
+        // 当前进程（或指定 PID）的全部可读内存
+        static PageSnapshot CaptureProcess(uint32_t pid = 0, const PageSnapshot* previous = nullptr, CaptureStats* stats = nullptr) {
+            return Capture(ProcessReader(pid), EnumerateRegions(pid), previous, stats);
+        }
+
+        // 内存 dump（整个缓冲区当作从 base 开始的一段内存，不足一页的尾部补零）
+        static PageSnapshot CaptureBuffer(const uint8_t* data, size_t size, uint64_t base = 0,
+                                          const PageSnapshot* previous = nullptr, CaptureStats* stats = nullptr) {
+            MemoryRegion region;
+            region.base = base;
+            region.size = size;
+            MemoryReader reader = [data, size, base](uint64_t address, void* dest, size_t length) {
+                uint64_t offset = address - base;
+                size_t available = offset < size ? size - (size_t)offset : 0;
+                size_t n = available < length ? available : length;
+                memcpy(dest, data + offset, n);
+                memset((uint8_t*)dest + n, 0, length - n);
+                return true;
+            };
+            return Capture(reader, { region }, previous, stats);
+        }
+
+        // 按地址二分查找
+        const SnapshotPage* Find(uint64_t address) const {
+            size_t lo = 0, hi = pages.size();
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (pages[mid].address < address) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo < pages.size() && pages[lo].address == address ? &pages[lo] : nullptr;
+        }
+
+        /*
+         * 按地址读取（可以跨页），拍快照时读不到的页返回 false
+         * 每次调用都要解压涉及的页，适合零散的少量读取（例如验证指针链）
+         */
+        bool Read(uint64_t address, void* dest, size_t size) const {
+            uint8_t buffer[PageSize];
+            uint8_t* out = (uint8_t*)dest;
+            while (size > 0) {
+                uint64_t pageAddress = address / PageSize * PageSize;
+                size_t offset = (size_t)(address - pageAddress);
+                size_t n = PageSize - offset < size ? PageSize - offset : size;
+                const SnapshotPage* page = Find(pageAddress);
+                if (!page || !page->Read(buffer)) return false;
+                memcpy(out, buffer + offset, n);
+                out += n;
+                address += n;
+                size -= n;
+            }
+            return true;
+        }
+
+        // 作为 MemoryReader 交给指针扫描等工具（快照必须比 reader 活得久）
+        MemoryReader Reader() const {
+            return [this](uint64_t address, void* dest, size_t size) { return Read(address, dest, size); };
+        }
+
+        const std::vector<MemoryRegion>& Regions() const { return regions; }
+        const std::vector<SnapshotPage>& Pages() const { return pages; }
+        size_t PageCount() const { return pages.size(); }
+        uint64_t CapturedBytes() const { return (uint64_t)pages.size() * PageSize; }
+
+        // 本快照引用的页数据总大小（与其它快照共用的页也算在内）
+        uint64_t StoredBytes() const {
+            uint64_t total = 0;
+            for (const SnapshotPage& page : pages) {
+                if (page.blob) total += page.blob->size();
+            }
+            return total;
+        }
+
+        static void Encode(const uint8_t* data, std::vector<uint8_t>& scratch, SnapshotPage& page) {
+            bool zero = true;
+            for (size_t j = 0; j < PageSize && zero; j += 8) zero = FastHash::Read64(data + j) == 0;
+            if (zero) {
+                page.encoding = PageEncoding::Zero;
+                page.blob.reset();
+                return;
+            }
+            PageCodec::Compress(data, PageSize, scratch);
+            if (scratch.size() < PageSize) {
+                page.encoding = PageEncoding::Compressed;
+                page.blob = std::make_shared<const std::vector<uint8_t>>(scratch);
+            }
+            else {
+                page.encoding = PageEncoding::Raw;
+                page.blob = std::make_shared<const std::vector<uint8_t>>(data, data + PageSize);
+            }
+        }
+
+    private:
+        std::vector<MemoryRegion> regions;
+        std::vector<SnapshotPage> pages;   // 按地址升序
+    };
+}
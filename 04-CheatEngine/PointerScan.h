@@ -0,0 +1,410 @@
+/*
+ * ========================================
+ * 第四课补充：指针扫描
+ * ========================================
+ *
+ * 任务2：找到血量地址后做指针扫描，得到重启后依然有效的路径
+ *   "CEPractice.exe"+0x1234 -> +0x0 -> +0x0 = 血量
+ *   即 g_Engine -> player -> health
+ *
+ * 朴素做法是递归：对目标地址扫一遍整个内存找"指向它附近的指针"，
+ * 再对每个结果重新扫一遍整个内存……每层都要全内存扫描，层数一多就没法用。
+ *
+ * 这里分两步：
+ * 1. 反向指针表：并行扫描一遍快照，收集所有 (指针值, 所在地址)，按指针值排序
+ *    之后"谁指向 [A - maxOffset, A]"只是一次二分查找
+ * 2. 从目标地址开始按层 BFS，直到静态基址（模块里的全局变量）或达到最大深度
+ *    每个地址只在第一次（最短）被发现时展开；之后在更深的层再遇到它只补一条边，
+ *    输出时沿这些边把 maxDepth 以内经过它的更长路径也枚举出来（和 CE 一样，不只报最短的）
+ */
+
+#pragma once
+#include "PageSnapshot.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace PointerScan {
+
+    using Snapshot::MemoryRegion;
+    using Snapshot::MemoryReader;
+
+    // ====================================
+    // 第一部分：模块表与区域查找
+    // ====================================
+
+    struct ModuleInfo {
+        std::string name;       // 只保留文件名（例如 CEPractice.exe）
+        uint64_t base = 0;
+        uint64_t size = 0;
+    };
+
+    inline std::string BaseName(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    class AddressSpace {
+    public:
+        AddressSpace() = default;
+
+        explicit AddressSpace(const std::vector<MemoryRegion>& input) : regions(input) {
+            std::sort(regions.begin(), regions.end(),
+                      [](const MemoryRegion& a, const MemoryRegion& b) { return a.base < b.base; });
+            for (const MemoryRegion& region : regions) {
+                regionModule.push_back(region.image ? ModuleIndex(region) : -1);
+            }
+        }
+
+        // 所在区域下标，不在任何区域返回 -1
+        int FindRegion(uint64_t address) const {
+            size_t lo = 0, hi = regions.size();
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (regions[mid].base <= address) lo = mid + 1;
+                else hi = mid;
+            }
+            if (lo == 0) return -1;
+            const MemoryRegion& region = regions[lo - 1];
+            return address - region.base < region.size ? (int)(lo - 1) : -1;
+        }
+
+        bool IsValidPointer(uint64_t value) const { return FindRegion(value) >= 0; }
+
+        // 静态地址所属模块下标，不是静态地址返回 -1
+        int StaticModule(uint64_t address) const {
+            int region = FindRegion(address);
+            return region < 0 ? -1 : regionModule[region];
+        }
+
+        const std::vector<MemoryRegion>& Regions() const { return regions; }
+        const std::vector<ModuleInfo>& Modules() const { return modules; }
+
+        int FindModule(const std::string& name) const {
+            for (size_t i = 0; i < modules.size(); i++) {
+                if (modules[i].name == name) return (int)i;
+            }
+            return -1;
+        }
+
+    private:
+        int ModuleIndex(const MemoryRegion& region) {
+            std::string name = region.name.empty() ? "module" : BaseName(region.name);
+            for (size_t i = 0; i < modules.size(); i++) {
+                if (modules[i].base == region.moduleBase) {
+                    uint64_t end = region.base + region.size - modules[i].base;
+                    if (end > modules[i].size) modules[i].size = end;
+                    return (int)i;
+                }
+            }
+            ModuleInfo module;
+            module.name = name;
+            module.base = region.moduleBase;
+            module.size = region.base + region.size - region.moduleBase;
+            modules.push_back(module);
+            return (int)modules.size() - 1;
+        }
+
+        std::vector<MemoryRegion> regions;
+        std::vector<int> regionModule;
+        std::vector<ModuleInfo> modules;
+    };
+
+    // ====================================
+    // 第二部分：反向指针表
+    // ====================================
+
+    struct PointerRef {
+        uint64_t value;      // 指针的值（指向哪里）
+        uint64_t location;   // 指针所在的地址
+
+        bool operator<(const PointerRef& other) const {
+            return value != other.value ? value < other.value : location < other.location;
+        }
+    };
+
+    struct MapOptions {
+        size_t pointerSize = sizeof(void*);   // 目标进程的指针宽度（4 或 8）
+        size_t chunkSize = 256 * 1024;        // 每个任务读取的字节数
+        unsigned threads = 0;
+    };
+
+    class PointerMap {
+    public:
+        /*
+         * 一次并行扫描建立反向表：
+         * 每个任务读取一块内存，挑出"值落在某个可读区域内"的对齐指针，块内排序；
+         * 最后把各块两两归并成一个有序数组
+         */
+        static PointerMap Build(const MemoryReader& reader, const std::vector<MemoryRegion>& regions,
+                                const MapOptions& options = MapOptions()) {
+            PointerMap map;
+            map.space = AddressSpace(regions);
+            map.pointerSize = options.pointerSize;
+
+            struct Job { uint64_t address; size_t size; };
+            std::vector<Job> jobs;
+            for (const MemoryRegion& region : map.space.Regions()) {
+                for (uint64_t offset = 0; offset < region.size; offset += options.chunkSize) {
+                    uint64_t remaining = region.size - offset;
+                    jobs.push_back({ region.base + offset, (size_t)(remaining < options.chunkSize ? remaining : options.chunkSize) });
+                }
+            }
+
+            std::vector<std::vector<PointerRef>> parts(jobs.size());
+            PatternEngine::ChunkStealingPool::Run(jobs.size(), options.threads, [&](size_t i) {
+                const Job& job = jobs[i];
+                std::vector<uint8_t> buffer(job.size);
+                // 整块读不了就逐页读，跳过读不到的页
+                if (reader(job.address, buffer.data(), job.size)) {
+                    map.Collect(buffer.data(), job.address, job.size, parts[i]);
+                }
+                else {
+                    for (size_t page = 0; page < job.size; page += Snapshot::PageSize) {
+                        size_t n = job.size - page < Snapshot::PageSize ? job.size - page : Snapshot::PageSize;
+                        if (reader(job.address + page, buffer.data() + page, n)) {
+                            map.Collect(buffer.data() + page, job.address + page, n, parts[i]);
+                        }
+                    }
+                }
+                std::sort(parts[i].begin(), parts[i].end());
+            });
+
+            // 拼接后按段两两归并（每轮的各次归并互不相交，可以并行）
+            std::vector<size_t> bounds(1, 0);
+            for (auto& part : parts) {
+                map.refs.insert(map.refs.end(), part.begin(), part.end());
+                bounds.push_back(map.refs.size());
+                std::vector<PointerRef>().swap(part);
+            }
+            while (bounds.size() > 2) {
+                size_t merges = (bounds.size() - 1) / 2;
+                PatternEngine::ChunkStealingPool::Run(merges, options.threads, [&](size_t m) {
+                    std::inplace_merge(map.refs.begin() + bounds[2 * m], map.refs.begin() + bounds[2 * m + 1],
+                                       map.refs.begin() + bounds[2 * m + 2]);
+                });
+                std::vector<size_t> next;
+                for (size_t b = 0; b < bounds.size(); b += 2) next.push_back(bounds[b]);
+                if (next.back() != bounds.back()) next.push_back(bounds.back());
+                bounds.swap(next);
+            }
+            return map;
+        }
+
+        // 对每个值落在 [low, high] 的指针调用 fn(ref)
+        template<typename Fn>
+        void ForEachPointingInto(uint64_t low, uint64_t high, Fn fn) const {
+            PointerRef key = { low, 0 };
+            for (auto it = std::lower_bound(refs.begin(), refs.end(), key); it != refs.end() && it->value <= high; ++it) {
+                fn(*it);
+            }
+        }
+
+        size_t Size() const { return refs.size(); }
+        size_t PointerSize() const { return pointerSize; }
+        const AddressSpace& Space() const { return space; }
+
+    private:
+        void Collect(const uint8_t* data, uint64_t address, size_t size, std::vector<PointerRef>& out) const {
+            // 只看按指针宽度对齐的位置
+            size_t start = (size_t)((pointerSize - address % pointerSize) % pointerSize);
+            for (size_t i = start; i + pointerSize <= size; i += pointerSize) {
+                uint64_t value = 0;
+                memcpy(&value, data + i, pointerSize);
+                if (value >= Snapshot::PageSize && space.IsValidPointer(value)) out.push_back({ value, address + i });
+            }
+        }
+
+        AddressSpace space;
+        size_t pointerSize = sizeof(void*);
+        std::vector<PointerRef> refs;   // 按 value 升序
+    };
+
+    // ====================================
+    // 第三部分：BFS 搜索指针路径
+    // ====================================
+
+    /*
+     * 路径：[module + baseOffset] + offsets[0] -> [...] + offsets[1] -> ... = 目标地址
+     * 以 g_Engine -> player -> health 为例：baseOffset 是 g_Engine 在模块中的偏移，offsets = { 0x0, 0x0 }
+     */
+    struct PointerPath {
+        uint32_t module = 0;
+        uint64_t baseOffset = 0;
+        std::vector<uint32_t> offsets;
+    };
+
+    struct ScanOptions {
+        unsigned maxDepth = 5;          // 最多几级指针
+        uint64_t maxOffset = 0x2000;    // 每一级允许的最大偏移（CE 提示里的 0x2000）
+        size_t maxResults = 1000000;    // 最多输出多少条路径
+        size_t maxNodes = 50000000;     // BFS 最多访问多少个地址（防止内存爆掉）
+        unsigned threads = 0;
+    };
+
+    class PointerScanner {
+    public:
+        explicit PointerScanner(const PointerMap& pointerMap) : map(pointerMap) {}
+
+        std::vector<PointerPath> Scan(uint64_t target, const ScanOptions& options = ScanOptions()) {
+            nodes.clear();
+            edges.clear();
+            index.clear();
+
+            AddNode(target, 0);
+            std::vector<uint32_t> frontier;
+            if (nodes[0].module < 0) frontier.push_back(0);
+
+            struct Found { uint64_t location; uint32_t child; uint32_t offset; };
+            const size_t perChunk = 256;
+
+            for (unsigned level = 1; level <= options.maxDepth && !frontier.empty(); level++) {
+                // 并行查反向表：每个任务处理一段 frontier
+                size_t chunks = (frontier.size() + perChunk - 1) / perChunk;
+                std::vector<std::vector<Found>> found(chunks);
+                PatternEngine::ChunkStealingPool::Run(chunks, options.threads, [&](size_t c) {
+                    size_t end = (c + 1) * perChunk < frontier.size() ? (c + 1) * perChunk : frontier.size();
+                    for (size_t i = c * perChunk; i < end; i++) {
+                        uint64_t address = nodes[frontier[i]].address;
+                        uint64_t low = address > options.maxOffset ? address - options.maxOffset : 0;
+                        map.ForEachPointingInto(low, address, [&](const PointerRef& ref) {
+                            found[c].push_back({ ref.location, frontier[i], (uint32_t)(address - ref.value) });
+                        });
+                    }
+                });
+
+                // 合并：新地址进入下一层；已见过的地址（本层或更浅层）不再展开，只加一条边
+                std::vector<uint32_t> next;
+                for (const auto& part : found) {
+                    for (const Found& f : part) {
+                        auto it = index.find(f.location);
+                        uint32_t node;
+                        if (it == index.end()) {
+                            if (nodes.size() >= options.maxNodes) continue;
+                            node = AddNode(f.location, level);
+                            if (nodes[node].module < 0) next.push_back(node);
+                        }
+                        else {
+                            node = it->second;
+                        }
+                        edges.push_back({ node, f.child, f.offset });
+                    }
+                }
+                frontier.swap(next);
+            }
+
+            return CollectPaths(options.maxDepth, options.maxResults);
+        }
+
+        size_t VisitedNodes() const { return nodes.size(); }
+
+    private:
+        struct Node {
+            uint64_t address;
+            uint32_t level;     // 到目标的最短层数
+            int module;         // 静态地址所属模块，否则 -1
+        };
+
+        struct Edge {
+            uint32_t from;      // 存放指针的地址
+            uint32_t to;        // 指针值 + offset
+            uint32_t offset;
+        };
+
+        uint32_t AddNode(uint64_t address, uint32_t level) {
+            uint32_t id = (uint32_t)nodes.size();
+            nodes.push_back({ address, level, map.Space().StaticModule(address) });
+            index.emplace(address, id);
+            return id;
+        }
+
+        // 从每个静态地址沿边走到目标，输出所有不超过 maxDepth 级的路径
+        std::vector<PointerPath> CollectPaths(unsigned maxDepth, size_t maxResults) {
+            std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+                return a.from != b.from ? a.from < b.from : a.offset < b.offset;
+            });
+            std::vector<size_t> first(nodes.size() + 1, 0);
+            for (const Edge& e : edges) first[e.from + 1]++;
+            for (size_t i = 0; i < nodes.size(); i++) first[i + 1] += first[i];
+
+            std::vector<PointerPath> results;
+            std::vector<uint32_t> offsets;
+            const auto& modules = map.Space().Modules();
+
+            // 目标本身就是静态地址
+            if (nodes[0].module >= 0) {
+                PointerPath path;
+                path.module = (uint32_t)nodes[0].module;
+                path.baseOffset = nodes[0].address - modules[nodes[0].module].base;
+                results.push_back(path);
+            }
+
+            std::vector<uint32_t> statics;
+            for (uint32_t i = 1; i < nodes.size(); i++) {
+                if (nodes[i].module >= 0) statics.push_back(i);
+            }
+            std::sort(statics.begin(), statics.end(), [&](uint32_t a, uint32_t b) {
+                return nodes[a].level != nodes[b].level ? nodes[a].level < nodes[b].level : nodes[a].address < nodes[b].address;
+            });
+
+            for (uint32_t s : statics) {
+                if (results.size() >= maxResults) break;
+                PointerPath base;
+                base.module = (uint32_t)nodes[s].module;
+                base.baseOffset = nodes[s].address - modules[nodes[s].module].base;
+                Walk(s, first, maxDepth, base, results, maxResults);
+            }
+            return results;
+        }
+
+        // 边可能成环（A 指向 B、B 又指向 A），靠层数上限终止：
+        // 下一个节点的最短层数放不进剩余层数就不走，走进去的分支一定能到达目标
+        void Walk(uint32_t node, const std::vector<size_t>& first, unsigned maxDepth, PointerPath& path,
+                  std::vector<PointerPath>& results, size_t maxResults) const {
+            if (node == 0) {
+                results.push_back(path);
+                return;
+            }
+            for (size_t e = first[node]; e < first[node + 1] && results.size() < maxResults; e++) {
+                if (path.offsets.size() + 1 + nodes[edges[e].to].level > maxDepth) continue;
+                path.offsets.push_back(edges[e].offset);
+                Walk(edges[e].to, first, maxDepth, path, results, maxResults);
+                path.offsets.pop_back();
+            }
+        }
+
+        const PointerMap& map;
+        std::vector<Node> nodes;
+        std::vector<Edge> edges;
+        std::unordered_map<uint64_t, uint32_t> index;
+    };
+
+    // ====================================
+    // 第四部分：解析与显示
+    // ====================================
+
+    // 按路径读取，得到最终地址；中途读取失败返回 false
+    inline bool Resolve(const MemoryReader& reader, uint64_t moduleBase, const PointerPath& path,
+                        uint64_t& result, size_t pointerSize = sizeof(void*)) {
+        uint64_t address = moduleBase + path.baseOffset;
+        for (uint32_t offset : path.offsets) {
+            uint64_t value = 0;
+            if (!reader(address, &value, pointerSize)) return false;
+            address = value + offset;
+        }
+        result = address;
+        return true;
+    }
+
+    // "CEPractice.exe"+0x1234 -> +0x0 -> +0x0
+    inline std::string Format(const PointerPath& path, const std::vector<ModuleInfo>& modules) {
+        char buffer[32];
+        std::string text = "\"" + (path.module < modules.size() ? modules[path.module].name : std::string("?")) + "\"";
+        snprintf(buffer, sizeof(buffer), "+0x%llX", (unsigned long long)path.baseOffset);
+        text += buffer;
+        for (uint32_t offset : path.offsets) {
+            snprintf(buffer, sizeof(buffer), " -> +0x%X", offset);
+            text += buffer;
+        }
+        return text;
+    }
+}
@@ -0,0 +1,393 @@
+/*
+ * ========================================
+ * 第四课补充：指针扫描结果文件
+ * ========================================
+ *
+ * 任务2 的第二步：重启程序，用新进程验证指针扫描的结果。
+ * 一次指针扫描可能得到几百万条路径，验证时要做到：
+ * - 结果文件紧凑：模块编号 + 基址偏移 + 变长整数编码的偏移列表
+ * - 文件可以直接 mmap，按块流式读取，不需要全部载入内存
+ * - 按 (模块名, 基址偏移, 偏移列表) 排序：相邻路径共用前缀，验证时可以复用已经读过的指针；
+ *   两个结果文件可以像归并排序一样流式求交集
+ *
+ * 文件格式（小端）：
+ *   头部 StoreHeader
+ *   模块表：moduleCount 个 (nameLength u16 | name)，按名字排序，模块编号 = 在表中的下标
+ *   路径记录：module | baseOffset | offsetCount | offsets...（全部是 LEB128 变长整数）
+ */
+
+#pragma once
+#include "PointerScan.h"
+#include "../03-ReverseTools/MappedFile.h"
+
+namespace PointerScan {
+
+    struct StoreHeader {
+        char magic[4];              // "PTRS"
+        uint32_t version;
+        uint32_t pointerSize;
+        uint32_t moduleCount;
+        uint64_t pathCount;
+        uint64_t recordsOffset;
+        uint64_t recordsSize;
+    };
+
+    constexpr uint32_t StoreVersion = 1;
+
+    inline void AppendVarint(std::vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((uint8_t)v);
+    }
+
+    // 带边界检查的变长整数读取（文件可能损坏）
+    inline bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) return false;
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // 同一个模块表下的路径顺序
+    inline bool PathLess(const PointerPath& a, const PointerPath& b) {
+        if (a.module != b.module) return a.module < b.module;
+        if (a.baseOffset != b.baseOffset) return a.baseOffset < b.baseOffset;
+        return a.offsets < b.offsets;
+    }
+
+    // ====================================
+    // 第一部分：写入
+    // ====================================
+
+    /*
+     * 流式写入：路径必须按 PathLess 的顺序 Add（验证、求交集的输出天然有序）
+     */
+    class PointerStoreWriter {
+    public:
+        ~PointerStoreWriter() {
+            if (file) {
+                fclose(file);
+                remove(temp.c_str());
+            }
+        }
+
+        bool Open(const std::string& filePath, const std::vector<std::string>& moduleNames, uint32_t pointerSize) {
+            path = filePath;
+            temp = filePath + ".tmp";
+            file = fopen(temp.c_str(), "wb");
+            if (!file) return false;
+
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, "PTRS", 4);
+            header.version = StoreVersion;
+            header.pointerSize = pointerSize;
+            header.moduleCount = (uint32_t)moduleNames.size();
+
+            // 头部先占位，Finish 时回填
+            std::vector<uint8_t> prefix(sizeof(header), 0);
+            for (const std::string& name : moduleNames) {
+                uint16_t length = (uint16_t)name.size();
+                prefix.push_back((uint8_t)length);
+                prefix.push_back((uint8_t)(length >> 8));
+                prefix.insert(prefix.end(), name.begin(), name.begin() + length);
+            }
+            header.recordsOffset = prefix.size();
+            return fwrite(prefix.data(), 1, prefix.size(), file) == prefix.size();
+        }
+
+        bool Add(const PointerPath& p) {
+            if (!file) return false;
+            AppendVarint(buffer, p.module);
+            AppendVarint(buffer, p.baseOffset);
+            AppendVarint(buffer, p.offsets.size());
+            for (uint32_t offset : p.offsets) AppendVarint(buffer, offset);
+            header.pathCount++;
+            return buffer.size() < (1 << 20) || Flush();
+        }
+
+        // 回填头部，然后改名为正式文件
+        bool Finish() {
+            if (!file) return false;
+            bool ok = Flush();
+            ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+            ok = (fclose(file) == 0) && ok;
+            file = nullptr;
+            if (!ok) {
+                remove(temp.c_str());
+                return false;
+            }
+            remove(path.c_str());  // Windows 上 rename 不能覆盖已有文件
+            return rename(temp.c_str(), path.c_str()) == 0;
+        }
+
+        uint64_t Count() const { return header.pathCount; }
+
+    private:
+        bool Flush() {
+            if (buffer.empty()) return true;
+            bool ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+            header.recordsSize += buffer.size();
+            buffer.clear();
+            return ok;
+        }
+
+        std::string path, temp;
+        FILE* file = nullptr;
+        StoreHeader header;
+        std::vector<uint8_t> buffer;
+    };
+
+    /*
+     * 保存指针扫描的结果：模块表按名字排序，路径按 PathLess 排序后写入
+     */
+    inline bool SavePaths(const std::string& filePath, const std::vector<ModuleInfo>& modules,
+                          std::vector<PointerPath> paths, uint32_t pointerSize = sizeof(void*)) {
+        std::vector<uint32_t> order(modules.size());
+        for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return modules[a].name < modules[b].name; });
+
+        std::vector<uint32_t> remap(modules.size());
+        std::vector<std::string> names;
+        for (uint32_t i = 0; i < order.size(); i++) {
+            remap[order[i]] = i;
+            names.push_back(modules[order[i]].name);
+        }
+        for (PointerPath& p : paths) p.module = remap[p.module];
+        std::sort(paths.begin(), paths.end(), PathLess);
+
+        PointerStoreWriter writer;
+        if (!writer.Open(filePath, names, pointerSize)) return false;
+        for (const PointerPath& p : paths) {
+            if (!writer.Add(p)) return false;
+        }
+        return writer.Finish();
+    }
+
+    // ====================================
+    // 第二部分：读取（mmap）
+    // ====================================
+
+    class PointerStore {
+    public:
+        bool Open(const std::string& filePath) {
+            names.clear();
+            if (!file.Open(filePath.c_str(), MappedFile::AccessHint::Sequential)) return false;
+            const uint8_t* data = file.Data();
+            size_t size = file.Size();
+            if (size < sizeof(StoreHeader)) return false;
+
+            memcpy(&header, data, sizeof(header));
+            if (memcmp(header.magic, "PTRS", 4) != 0 || header.version != StoreVersion) return false;
+            if (header.recordsOffset > size || header.recordsSize > size - header.recordsOffset) return false;
+
+            const uint8_t* p = data + sizeof(StoreHeader);
+            const uint8_t* end = data + header.recordsOffset;
+            for (uint32_t i = 0; i < header.moduleCount; i++) {
+                if (end - p < 2) return false;
+                uint16_t length = (uint16_t)(p[0] | (p[1] << 8));
+                p += 2;
+                if (end - p < length) return false;
+                names.emplace_back((const char*)p, length);
+                p += length;
+            }
+            return true;
+        }
+
+        // 顺序读取路径
+        class Cursor {
+        public:
+            Cursor(const uint8_t* begin, const uint8_t* end) : p(begin), limit(end) {}
+
+            bool Next(PointerPath& out) {
+                uint64_t module, base, count;
+                if (p >= limit || !ReadVarint(p, limit, module) || !ReadVarint(p, limit, base)
+                    || !ReadVarint(p, limit, count) || count > 64) return false;
+                out.module = (uint32_t)module;
+                out.baseOffset = base;
+                out.offsets.resize((size_t)count);
+                for (uint64_t i = 0; i < count; i++) {
+                    uint64_t offset;
+                    if (!ReadVarint(p, limit, offset)) return false;
+                    out.offsets[i] = (uint32_t)offset;
+                }
+                return true;
+            }
+
+        private:
+            const uint8_t* p;
+            const uint8_t* limit;
+        };
+
+        Cursor Begin() const {
+            const uint8_t* records = file.Data() ? file.Data() + header.recordsOffset : nullptr;
+            return Cursor(records, records ? records + header.recordsSize : nullptr);
+        }
+
+        // 每次取出最多 batchSize 条路径交给 fn，内存占用只和批大小有关
+        template<typename Fn>
+        void ForEachBatch(size_t batchSize, Fn fn) const {
+            Cursor cursor = Begin();
+            std::vector<PointerPath> batch(batchSize);
+            for (;;) {
+                size_t n = 0;
+                while (n < batchSize && cursor.Next(batch[n])) n++;
+                if (n == 0) break;
+                batch.resize(n);
+                fn(batch);
+                if (n < batchSize) break;
+                batch.resize(batchSize);
+            }
+        }
+
+        const std::vector<std::string>& ModuleNames() const { return names; }
+        uint64_t Count() const { return header.pathCount; }
+        uint32_t PointerSize() const { return header.pointerSize; }
+
+    private:
+        MappedFile file;
+        StoreHeader header = {};
+        std::vector<std::string> names;
+    };
+
+    // ====================================
+    // 第三部分：流式验证与求交集
+    // ====================================
+
+    struct ValidateStats {
+        uint64_t checked = 0;
+        uint64_t survived = 0;
+        uint64_t missingModule = 0;     // 新进程里找不到这个模块
+    };
+
+    /*
+     * 用新进程（或新快照）验证结果文件：
+     * 每批路径并行解析，解析结果等于 target 的写入 output
+     * 同一批内相邻路径的公共前缀只读一次
+     */
+    inline bool ValidateStore(const std::string& input, const std::string& output,
+                              const MemoryReader& reader, const AddressSpace& space, uint64_t target,
+                              ValidateStats* stats = nullptr, size_t batchSize = 65536, unsigned threads = 0) {
+        PointerStore store;
+        if (!store.Open(input)) return false;
+
+        // 按模块名重新定位基址（ASLR 每次启动都不同）
+        const size_t pointerSize = store.PointerSize();
+        std::vector<int64_t> moduleBase;
+        for (const std::string& name : store.ModuleNames()) {
+            int m = space.FindModule(name);
+            moduleBase.push_back(m < 0 ? -1 : (int64_t)space.Modules()[m].base);
+        }
+
+        PointerStoreWriter writer;
+        if (!writer.Open(output, store.ModuleNames(), (uint32_t)pointerSize)) return false;
+
+        ValidateStats local;
+        bool ok = true;
+        const size_t perTask = 1024;
+        store.ForEachBatch(batchSize, [&](const std::vector<PointerPath>& batch) {
+            std::vector<uint8_t> alive(batch.size(), 0);
+            size_t tasks = (batch.size() + perTask - 1) / perTask;
+
+            PatternEngine::ChunkStealingPool::Run(tasks, threads, [&](size_t t) {
+                // chain[i] = 第 i 步之后的地址；known = chain 中对上一条路径有效的步数
+                std::vector<uint64_t> chain;
+                size_t known = 0;
+                const PointerPath* previous = nullptr;
+                size_t end = (t + 1) * perTask < batch.size() ? (t + 1) * perTask : batch.size();
+
+                for (size_t i = t * perTask; i < end; i++) {
+                    const PointerPath& p = batch[i];
+                    if (p.module >= moduleBase.size() || moduleBase[p.module] < 0) {
+                        previous = nullptr;
+                        continue;
+                    }
+                    size_t common = 0;
+                    if (previous && previous->module == p.module && previous->baseOffset == p.baseOffset) {
+                        common = 1;
+                        while (common - 1 < p.offsets.size() && common - 1 < previous->offsets.size()
+                               && p.offsets[common - 1] == previous->offsets[common - 1]) common++;
+                    }
+                    if (common > known) common = known;
+                    if (common == 0) {
+                        chain.assign(1, (uint64_t)moduleBase[p.module] + p.baseOffset);
+                        common = 1;
+                    }
+                    chain.resize(common);
+
+                    bool readable = true;
+                    for (size_t s = common - 1; s < p.offsets.size(); s++) {
+                        uint64_t value = 0;
+                        if (!reader(chain[s], &value, pointerSize)) {
+                            readable = false;
+                            break;
+                        }
+                        chain.push_back(value + p.offsets[s]);
+                    }
+                    known = chain.size();
+                    previous = &p;
+                    alive[i] = readable && chain.back() == target;
+                }
+            });
+
+            for (size_t i = 0; i < batch.size(); i++) {
+                const PointerPath& p = batch[i];
+                if (p.module >= moduleBase.size() || moduleBase[p.module] < 0) local.missingModule++;
+                if (alive[i]) {
+                    ok = ok && writer.Add(p);
+                    local.survived++;
+                }
+            }
+            local.checked += batch.size();
+        });
+
+        if (stats) *stats = local;
+        return writer.Finish() && ok;
+    }
+
+    /*
+     * 两个结果文件（例如两次独立的指针扫描）求交集：
+     * 两边都按 (模块名, 基址偏移, 偏移列表) 有序，像归并排序一样同时向前走
+     * 输出使用 a 的模块表
+     */
+    inline bool IntersectStores(const std::string& a, const std::string& b, const std::string& output) {
+        PointerStore left, right;
+        if (!left.Open(a) || !right.Open(b)) return false;
+
+        const auto& leftNames = left.ModuleNames();
+        const auto& rightNames = right.ModuleNames();
+        auto compare = [&](const PointerPath& x, const PointerPath& y) {
+            const std::string& nx = x.module < leftNames.size() ? leftNames[x.module] : std::string();
+            const std::string& ny = y.module < rightNames.size() ? rightNames[y.module] : std::string();
+            int c = nx.compare(ny);
+            if (c != 0) return c;
+            if (x.baseOffset != y.baseOffset) return x.baseOffset < y.baseOffset ? -1 : 1;
+            if (x.offsets != y.offsets) return x.offsets < y.offsets ? -1 : 1;
+            return 0;
+        };
+
+        PointerStoreWriter writer;
+        if (!writer.Open(output, leftNames, left.PointerSize())) return false;
+
+        PointerStore::Cursor lc = left.Begin(), rc = right.Begin();
+        PointerPath x, y;
+        bool hasX = lc.Next(x), hasY = rc.Next(y);
+        bool ok = true;
+        while (hasX && hasY && ok) {
+            int c = compare(x, y);
+            if (c < 0) hasX = lc.Next(x);
+            else if (c > 0) hasY = rc.Next(y);
+            else {
+                ok = writer.Add(x);
+                hasX = lc.Next(x);
+                hasY = rc.Next(y);
+            }
+        }
+        return writer.Finish() && ok;
+    }
+}
@@ -0,0 +1,524 @@
+/*
+ * ========================================
+ * 第四课补充：进程快照文件（离线扫描）
+ * ========================================
+ *
+ * ReverseTools.h 里的工具都假设 Windows + 正在运行的进程。
+ * 把进程内存整个存成一个文件之后：
+ * - 数值扫描、指针扫描、特征码扫描都可以离线、反复、多线程地跑
+ * - Linux 上也能用（练习程序在 Linux 下编译时走 /proc/<pid>/maps）
+ *
+ * 文件布局（小端）：
+ *   SnapshotFileHeader
+ *   区域表 RegionEntry[regionCount] + 区域名字符串
+ *   块索引 BlockEntry[blockCount]（每个区域按 blockSize 切块，区域的块是连续的）
+ *   数据（从页边界开始）
+ *
+ * 压缩方式：
+ * - None：每块原样存放，区域数据在文件里是连续的 —— mmap 后直接把指针交给扫描函数，零拷贝
+ * - PageLZ：内置的 LZ 压缩（PageSnapshot.h），不依赖任何库
+ * - Zstd：需要定义 SNAPSHOT_WITH_ZSTD 并链接 libzstd
+ * 全零块和读不到的块都不占数据空间（None 模式下为了连续仍写入 0）
+ */
+
+#pragma once
+#include "PageSnapshot.h"
+#include "../03-ReverseTools/MappedFile.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(SNAPSHOT_WITH_ZSTD)
+#if defined(__has_include)
+#if !__has_include(<zstd.h>)
+#error "SNAPSHOT_WITH_ZSTD 需要 zstd 头文件（libzstd-dev）"
+#endif
+#endif
+#include <zstd.h>
+#endif
+
+namespace Snapshot {
+
+    enum class FileCodec : uint32_t {
+        None = 0,
+        PageLZ = 1,
+        Zstd = 2
+    };
+
+    inline bool CodecAvailable(FileCodec codec) {
+#if defined(SNAPSHOT_WITH_ZSTD)
+        return codec <= FileCodec::Zstd;
+#else
+        return codec <= FileCodec::PageLZ;
+#endif
+    }
+
+    struct SnapshotFileHeader {
+        char magic[4];              // "SNAP"
+        uint32_t version;
+        uint32_t codec;
+        uint32_t blockSize;
+        uint32_t regionCount;
+        uint32_t reserved;
+        uint64_t blockCount;
+        uint64_t regionTableOffset;
+        uint64_t namesOffset;
+        uint64_t blockIndexOffset;
+        uint64_t dataOffset;
+    };
+
+    struct RegionEntry {
+        uint64_t base;
+        uint64_t size;
+        uint64_t moduleBase;
+        uint64_t firstBlock;
+        uint32_t flags;             // RegionWritable | RegionExecutable | RegionImage
+        uint32_t nameOffset;        // 相对 namesOffset
+        uint32_t nameLength;
+        uint32_t reserved;
+    };
+
+    // RegionEntry::flags
+    constexpr uint32_t RegionWritable = 1;
+    constexpr uint32_t RegionExecutable = 2;
+    constexpr uint32_t RegionImage = 4;
+
+    enum class BlockKind : uint32_t {
+        Raw = 0,
+        Compressed = 1,
+        Zero = 2,
+        Missing = 3                 // 拍快照时读不到
+    };
+
+    struct BlockEntry {
+        uint64_t offset;            // 文件偏移
+        uint32_t storedSize;
+        uint32_t kind;              // BlockKind
+    };
+
+    constexpr uint32_t SnapshotFileVersion = 1;
+
+    struct SnapshotFileOptions {
+        FileCodec codec = FileCodec::None;
+        uint32_t blockSize = 64 * 1024;     // PageLZ 的偏移是 16 位，块不能超过 64KB
+        int zstdLevel = 3;
+        size_t batchBlocks = 256;           // 每批并行读取/压缩的块数（决定写入时的内存占用）
+        unsigned threads = 0;
+    };
+
+    // ====================================
+    // 第一部分：写入
+    // ====================================
+
+    namespace Detail {
+
+        struct PendingBlock {
+            uint64_t address = 0;
+            uint32_t size = 0;
+            BlockKind kind = BlockKind::Raw;
+            std::vector<uint8_t> data;
+        };
+
+        // 读取一块：整块读失败就逐页读，读不到的页补 0；一页都读不到算 Missing
+        inline void ReadBlock(const MemoryReader& reader, PendingBlock& block, std::vector<uint8_t>& raw) {
+            raw.assign(block.size, 0);
+            if (reader(block.address, raw.data(), block.size)) return;
+            bool any = false;
+            for (uint32_t offset = 0; offset < block.size; offset += (uint32_t)PageSize) {
+                uint32_t n = block.size - offset < PageSize ? block.size - offset : (uint32_t)PageSize;
+                if (reader(block.address + offset, raw.data() + offset, n)) any = true;
+                else memset(raw.data() + offset, 0, n);
+            }
+            if (!any) block.kind = BlockKind::Missing;
+        }
+
+        inline bool IsZero(const std::vector<uint8_t>& raw) {
+            for (uint8_t b : raw) {
+                if (b) return false;
+            }
+            return true;
+        }
+
+        inline void EncodeBlock(const SnapshotFileOptions& options, std::vector<uint8_t>& raw, PendingBlock& block) {
+            if (options.codec == FileCodec::None) {
+                block.data.swap(raw);           // 缺失的块也写 0，保证区域数据连续
+                return;
+            }
+            if (block.kind == BlockKind::Missing) return;
+            if (IsZero(raw)) {
+                block.kind = BlockKind::Zero;
+                return;
+            }
+            if (options.codec == FileCodec::PageLZ) {
+                PageCodec::Compress(raw.data(), raw.size(), block.data);
+            }
+#if defined(SNAPSHOT_WITH_ZSTD)
+            else {
+                block.data.resize(ZSTD_compressBound(raw.size()));
+                size_t n = ZSTD_compress(block.data.data(), block.data.size(), raw.data(), raw.size(), options.zstdLevel);
+                block.data.resize(ZSTD_isError(n) ? raw.size() + 1 : n);
+            }
+#endif
+            if (block.data.size() < raw.size()) {
+                block.kind = BlockKind::Compressed;
+            }
+            else {
+                block.kind = BlockKind::Raw;
+                block.data.swap(raw);
+            }
+        }
+    }
+
+    /*
+     * 把 regions 的内容写入快照文件
+     * 读取和压缩按批并行，写入按顺序进行；先写临时文件，成功后改名
+     */
+    inline bool WriteSnapshotFile(const std::string& path, const MemoryReader& reader,
+                                  std::vector<MemoryRegion> regions,
+                                  const SnapshotFileOptions& options = SnapshotFileOptions()) {
+        if (!CodecAvailable(options.codec) || options.blockSize == 0 || options.blockSize % PageSize != 0
+            || (options.codec == FileCodec::PageLZ && options.blockSize > 64 * 1024)) return false;
+
+        // 读取时按地址二分查找区域
+        std::sort(regions.begin(), regions.end(),
+                  [](const MemoryRegion& a, const MemoryRegion& b) { return a.base < b.base; });
+
+        // 区域表与块列表
+        std::vector<RegionEntry> entries;
+        std::string names;
+        std::vector<Detail::PendingBlock> blocks;
+        for (const MemoryRegion& region : regions) {
+            RegionEntry entry = {};
+            entry.base = region.base;
+            entry.size = region.size;
+            entry.moduleBase = region.moduleBase;
+            entry.firstBlock = blocks.size();
+            entry.flags = (region.writable ? RegionWritable : 0u) | (region.executable ? RegionExecutable : 0u)
+                        | (region.image ? RegionImage : 0u);
+            entry.nameOffset = (uint32_t)names.size();
+            entry.nameLength = (uint32_t)region.name.size();
+            names += region.name;
+            entries.push_back(entry);
+
+            for (uint64_t offset = 0; offset < region.size; offset += options.blockSize) {
+                Detail::PendingBlock block;
+                block.address = region.base + offset;
+                block.size = (uint32_t)(region.size - offset < options.blockSize ? region.size - offset : options.blockSize);
+                blocks.push_back(std::move(block));
+            }
+        }
+
+        SnapshotFileHeader header = {};
+        memcpy(header.magic, "SNAP", 4);
+        header.version = SnapshotFileVersion;
+        header.codec = (uint32_t)options.codec;
+        header.blockSize = options.blockSize;
+        header.regionCount = (uint32_t)entries.size();
+        header.blockCount = blocks.size();
+        header.regionTableOffset = sizeof(SnapshotFileHeader);
+        header.namesOffset = header.regionTableOffset + entries.size() * sizeof(RegionEntry);
+        header.blockIndexOffset = (header.namesOffset + names.size() + 7) / 8 * 8;
+        header.dataOffset = (header.blockIndexOffset + blocks.size() * sizeof(BlockEntry) + PageSize - 1) / PageSize * PageSize;
+
+        std::string temp = path + ".tmp";
+        FILE* file = fopen(temp.c_str(), "wb");
+        if (!file) return false;
+
+        // 块索引要等数据写完才知道，先写 0 占位
+        std::vector<uint8_t> prefix(header.dataOffset, 0);
+        memcpy(prefix.data(), &header, sizeof(header));
+        if (!entries.empty()) memcpy(prefix.data() + header.regionTableOffset, entries.data(), entries.size() * sizeof(RegionEntry));
+        memcpy(prefix.data() + header.namesOffset, names.data(), names.size());
+        bool ok = fwrite(prefix.data(), 1, prefix.size(), file) == prefix.size();
+
+        std::vector<BlockEntry> index(blocks.size());
+        uint64_t offset = header.dataOffset;
+        for (size_t first = 0; ok && first < blocks.size(); first += options.batchBlocks) {
+            size_t last = first + options.batchBlocks < blocks.size() ? first + options.batchBlocks : blocks.size();
+            PatternEngine::ChunkStealingPool::Run(last - first, options.threads, [&](size_t i) {
+                std::vector<uint8_t> raw;
+                Detail::PendingBlock& block = blocks[first + i];
+                Detail::ReadBlock(reader, block, raw);
+                Detail::EncodeBlock(options, raw, block);
+            });
+            for (size_t b = first; ok && b < last; b++) {
+                Detail::PendingBlock& block = blocks[b];
+                index[b].offset = offset;
+                index[b].storedSize = (uint32_t)block.data.size();
+                index[b].kind = (uint32_t)block.kind;
+                ok = block.data.empty() || fwrite(block.data.data(), 1, block.data.size(), file) == block.data.size();
+                offset += block.data.size();
+                std::vector<uint8_t>().swap(block.data);
+            }
+        }
+
+        ok = ok && fseek(file, (long)header.blockIndexOffset, SEEK_SET) == 0
+                && (index.empty() || fwrite(index.data(), sizeof(BlockEntry), index.size(), file) == index.size());
+        ok = (fclose(file) == 0) && ok;
+        if (!ok) {
+            remove(temp.c_str());
+            return false;
+        }
+        remove(path.c_str());  // Windows 上 rename 不能覆盖已有文件
+        return rename(temp.c_str(), path.c_str()) == 0;
+    }
+
+    // 拍下进程（pid 为 0 表示当前进程）的全部可读内存
+    inline bool CaptureProcessToFile(const std::string& path, uint32_t pid = 0,
+                                     const SnapshotFileOptions& options = SnapshotFileOptions()) {
+        return WriteSnapshotFile(path, ProcessReader(pid), EnumerateRegions(pid), options);
+    }
+
+    // ====================================
+    // 第二部分：读取（mmap）
+    // ====================================
+
+    class SnapshotFile {
+    public:
+        bool Open(const std::string& path) {
+            generation = NextGeneration();
+            regions.clear();
+            entries = nullptr;
+            blocks = nullptr;
+            if (!file.Open(path.c_str(), MappedFile::AccessHint::Random)) return false;
+
+            const uint8_t* data = file.Data();
+            size_t size = file.Size();
+            if (size < sizeof(SnapshotFileHeader)) return false;
+            memcpy(&header, data, sizeof(header));
+            if (memcmp(header.magic, "SNAP", 4) != 0 || header.version != SnapshotFileVersion) return false;
+            if (!CodecAvailable((FileCodec)header.codec) || header.blockSize == 0) return false;
+            if (header.namesOffset > size || header.regionTableOffset > header.namesOffset
+                || header.regionTableOffset + (uint64_t)header.regionCount * sizeof(RegionEntry) > header.namesOffset
+                || header.blockIndexOffset > size || header.blockCount > (size - header.blockIndexOffset) / sizeof(BlockEntry)) return false;
+
+            entries = (const RegionEntry*)(data + header.regionTableOffset);
+            blocks = (const BlockEntry*)(data + header.blockIndexOffset);
+            for (uint32_t i = 0; i < header.regionCount; i++) {
+                const RegionEntry& entry = entries[i];
+                uint64_t blockCount = entry.size / header.blockSize + (entry.size % header.blockSize != 0);
+                if (entry.firstBlock > header.blockCount || blockCount > header.blockCount - entry.firstBlock
+                    || header.namesOffset + entry.nameOffset + entry.nameLength > header.blockIndexOffset) return false;
+                // FindRegion 按 base 二分查找：区域必须升序且互不重叠
+                if (entry.base + entry.size < entry.base) return false;
+                if (i > 0 && entry.base < entries[i - 1].base + entries[i - 1].size) return false;
+                if (!ValidateBlocks(entry, size)) return false;
+
+                MemoryRegion region;
+                region.base = entry.base;
+                region.size = entry.size;
+                region.moduleBase = entry.moduleBase;
+                region.writable = (entry.flags & RegionWritable) != 0;
+                region.executable = (entry.flags & RegionExecutable) != 0;
+                region.image = (entry.flags & RegionImage) != 0;
+                region.name.assign((const char*)data + header.namesOffset + entry.nameOffset, entry.nameLength);
+                regions.push_back(region);
+            }
+            return true;
+        }
+
+        const std::vector<MemoryRegion>& Regions() const { return regions; }
+        FileCodec Codec() const { return (FileCodec)header.codec; }
+        uint32_t BlockSize() const { return header.blockSize; }
+
+        /*
+         * 未压缩的快照：区域 i 的内容在映射中的起点（连续 Regions()[i].size 字节）
+         * 可以直接交给 ValueScan::FirstScan / PatternEngine::FindAll；压缩的快照返回 nullptr
+         */
+        const uint8_t* RegionData(size_t i) const {
+            if (header.codec != (uint32_t)FileCodec::None || i >= regions.size() || regions[i].size == 0) return nullptr;
+            return file.Data() + blocks[entries[i].firstBlock].offset;
+        }
+
+        // 解出一块到 out（blockSize 字节以内），读不到的块返回 false
+        bool ReadBlock(uint64_t b, uint8_t* out, size_t size) const {
+            const BlockEntry& block = blocks[b];
+            const uint8_t* stored = file.Data() + block.offset;
+            switch ((BlockKind)block.kind) {
+                case BlockKind::Raw:
+                    if (block.storedSize != size) return false;
+                    memcpy(out, stored, size);
+                    return true;
+                case BlockKind::Zero:
+                    memset(out, 0, size);
+                    return true;
+                case BlockKind::Compressed:
+                    if (header.codec == (uint32_t)FileCodec::PageLZ) {
+                        return PageCodec::Decompress(stored, block.storedSize, out, size);
+                    }
+#if defined(SNAPSHOT_WITH_ZSTD)
+                    return ZSTD_decompress(out, size, stored, block.storedSize) == size;
+#else
+                    return false;
+#endif
+                default:
+                    return false;
+            }
+        }
+
+        // 按地址读取（可以跨块、跨区域），用于指针链解析等零散读取
+        bool Read(uint64_t address, void* dest, size_t size) const {
+            uint8_t* out = (uint8_t*)dest;
+            while (size > 0) {
+                int r = FindRegion(address);
+                if (r < 0) return false;
+                const RegionEntry& entry = entries[r];
+                uint64_t offset = address - entry.base;
+                uint64_t b = entry.firstBlock + offset / header.blockSize;
+                size_t inBlock = (size_t)(offset % header.blockSize);
+                size_t blockLength = (size_t)(entry.size - (b - entry.firstBlock) * header.blockSize);
+                if (blockLength > header.blockSize) blockLength = header.blockSize;
+                size_t n = blockLength - inBlock < size ? blockLength - inBlock : size;
+
+                if ((BlockKind)blocks[b].kind == BlockKind::Missing) return false;
+                if ((BlockKind)blocks[b].kind == BlockKind::Raw) {
+                    memcpy(out, file.Data() + blocks[b].offset + inBlock, n);
+                }
+                else {
+                    // 每个线程缓存最近解压的一块：指针链解析经常连续读同一块
+                    // 用每次 Open 分配的编号做键而不是 this：重新 Open 或同一地址上的新对象都不会读到旧文件的数据
+                    thread_local uint64_t cachedGeneration = 0;
+                    thread_local uint64_t cachedBlock = 0;
+                    thread_local std::vector<uint8_t> cache;
+                    if (cachedGeneration != generation || cachedBlock != b || cache.size() != blockLength) {
+                        cache.resize(blockLength);
+                        cachedGeneration = 0;
+                        if (!ReadBlock(b, cache.data(), blockLength)) return false;
+                        cachedGeneration = generation;
+                        cachedBlock = b;
+                    }
+                    memcpy(out, cache.data() + inBlock, n);
+                }
+                out += n;
+                address += n;
+                size -= n;
+            }
+            return true;
+        }
+
+        MemoryReader Reader() const {
+            return [this](uint64_t address, void* dest, size_t size) { return Read(address, dest, size); };
+        }
+
+        /*
+         * 并行遍历所有块：fn(region, address, data, size)
+         * 未压缩时 data 直接指向映射，压缩时指向各线程自己的解压缓冲区
+         * 注意：跨块边界的值/特征码需要扫描方自己处理（未压缩时可以改用 RegionData 整段扫描）
+         */
+        template<typename Fn>
+        void ForEachBlock(Fn fn, unsigned threads = 0) const {
+            struct Job { uint32_t region; uint64_t block; };
+            std::vector<Job> jobs;
+            for (uint32_t r = 0; r < regions.size(); r++) {
+                uint64_t count = (regions[r].size + header.blockSize - 1) / header.blockSize;
+                for (uint64_t i = 0; i < count; i++) jobs.push_back({ r, entries[r].firstBlock + i });
+            }
+            PatternEngine::ChunkStealingPool::Run(jobs.size(), threads, [&](size_t j) {
+                const Job& job = jobs[j];
+                const MemoryRegion& region = regions[job.region];
+                uint64_t offset = (job.block - entries[job.region].firstBlock) * header.blockSize;
+                size_t size = (size_t)(region.size - offset < header.blockSize ? region.size - offset : header.blockSize);
+                const BlockEntry& block = blocks[job.block];
+                if ((BlockKind)block.kind == BlockKind::Missing) return;
+                if ((BlockKind)block.kind == BlockKind::Raw) {
+                    fn(region, region.base + offset, file.Data() + block.offset, size);
+                    return;
+                }
+                std::vector<uint8_t> buffer(size);
+                if (ReadBlock(job.block, buffer.data(), size)) fn(region, region.base + offset, buffer.data(), size);
+            });
+        }
+
+        /*
+         * 特征码扫描，返回命中地址（升序）
+         * 未压缩：整段区域直接在映射上多线程扫描；压缩：逐块解压，每块多读 length - 1 字节接住跨块的命中
+         */
+        std::vector<uint64_t> FindPattern(const PatternEngine::CompiledPattern& pattern, unsigned threads = 0) const {
+            std::vector<uint64_t> hits;
+            for (size_t r = 0; r < regions.size(); r++) {
+                const MemoryRegion& region = regions[r];
+                if (const uint8_t* data = RegionData(r)) {
+                    PatternEngine::ParallelScanOptions options;
+                    options.threads = threads;
+                    for (size_t offset : PatternEngine::ParallelFindAll(data, (size_t)region.size, pattern, options)) {
+                        hits.push_back(region.base + offset);
+                    }
+                    continue;
+                }
+
+                uint64_t count = (region.size + header.blockSize - 1) / header.blockSize;
+                std::vector<std::vector<uint64_t>> parts(count);
+                PatternEngine::ChunkStealingPool::Run(count, threads, [&](size_t i) {
+                    uint64_t offset = i * header.blockSize;
+                    size_t size = (size_t)(region.size - offset < header.blockSize ? region.size - offset : header.blockSize);
+                    size_t overlap = pattern.Size() > 1 ? pattern.Size() - 1 : 0;
+                    if (overlap > region.size - offset - size) overlap = (size_t)(region.size - offset - size);
+
+                    std::vector<uint8_t> buffer(size + overlap);
+                    if (!Read(region.base + offset, buffer.data(), size)) return;
+                    if (overlap && !Read(region.base + offset + size, buffer.data() + size, overlap)) buffer.resize(size);
+                    PatternEngine::ForEachMatch(buffer.data(), buffer.size(), pattern, [&](size_t hit) {
+                        if (hit >= size) return false;
+                        parts[i].push_back(region.base + offset + hit);
+                        return true;
+                    });
+                });
+                for (const auto& part : parts) hits.insert(hits.end(), part.begin(), part.end());
+            }
+            return hits;
+        }
+
+    private:
+        /*
+         * 一个区域的块：存储范围在文件内；Raw 块存的正好是整块长度（读取时按块长度直接拷贝）；
+         * 未压缩的快照里每块都带数据并且首尾相接（RegionData 把整个区域当成连续内存）
+         */
+        bool ValidateBlocks(const RegionEntry& entry, size_t size) const {
+            const bool contiguous = header.codec == (uint32_t)FileCodec::None;
+            for (uint64_t offset = 0, b = entry.firstBlock; offset < entry.size; offset += header.blockSize, b++) {
+                const BlockEntry& block = blocks[b];
+                uint64_t length = entry.size - offset < header.blockSize ? entry.size - offset : header.blockSize;
+                if (block.offset > size || block.storedSize > size - block.offset) return false;
+                switch ((BlockKind)block.kind) {
+                    case BlockKind::Raw:
+                        if (block.storedSize != length) return false;
+                        break;
+                    case BlockKind::Missing:
+                        if (contiguous && block.storedSize != length) return false;
+                        break;
+                    case BlockKind::Compressed:
+                    case BlockKind::Zero:
+                        if (contiguous) return false;
+                        break;
+                    default:
+                        return false;
+                }
+                if (contiguous && offset > 0 && block.offset != blocks[b - 1].offset + blocks[b - 1].storedSize) return false;
+            }
+            return true;
+        }
+
+        int FindRegion(uint64_t address) const {
+            size_t lo = 0, hi = regions.size();
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (regions[mid].base <= address) lo = mid + 1;
+                else hi = mid;
+            }
+            if (lo == 0) return -1;
+            return address - regions[lo - 1].base < regions[lo - 1].size ? (int)(lo - 1) : -1;
+        }
+
+        // 全局递增，从 1 开始（0 表示线程缓存为空）
+        static uint64_t NextGeneration() {
+            static std::atomic<uint64_t> counter{ 0 };
+            return ++counter;
+        }
+
+        MappedFile file;
+        uint64_t generation = 0;
+        SnapshotFileHeader header = {};
+        const RegionEntry* entries = nullptr;
+        const BlockEntry* blocks = nullptr;
+        std::vector<MemoryRegion> regions;
+    };
+}
@@ -0,0 +1,161 @@
+/*
+ * ========================================
+ * 第四课补充：未知初始值扫描
+ * ========================================
+ *
+ * 不知道血量是多少（或者界面上显示的是百分比）时，CE 的做法是：
+ *   首次扫描选"未知初始值" -> 把所有地址都当作候选
+ *   之后用"变动的值/未变动的值/增加的值/减少的值"逐步缩小范围
+ *
+ * 把整个地址空间的每个位置都存成候选是不可能的，这里的候选以"页"为单位：
+ * - 整页都是候选：只存这一页的快照（压缩数据，和快照共用），不存位图
+ * - 部分是候选：再加一个页内位图
+ * - 页哈希没变：变动/增加/减少扫描直接丢掉整页，未变动扫描直接保留整页，不用解压比较
+ * 只有哈希变了的页才需要解压逐个比较，所以内存和耗时都只和"变化的数据量"有关。
+ */
+
+#pragma once
+#include "NextScan.h"
+#include "PageSnapshot.h"
+
+namespace ValueScan {
+
+    template<typename T>
+    class UnknownValueScan {
+    public:
+        static constexpr size_t PagesPerChunk = 64;
+
+        // 以一张快照作为初始值：所有页、所有位置都是候选
+        explicit UnknownValueScan(const Snapshot::PageSnapshot& baseline, size_t strideBytes = sizeof(T))
+            : stride(strideBytes), positionsPerPage(PositionCount(Snapshot::PageSize, sizeof(T), strideBytes)) {
+            for (const Snapshot::SnapshotPage& page : baseline.Pages()) {
+                PageState state;
+                state.page = page;
+                state.all = true;
+                state.count = (uint32_t)positionsPerPage;
+                states.push_back(std::move(state));
+            }
+        }
+
+        /*
+         * 再次扫描：current 是新拍的快照（最好以上一张为 previous 拍，页数据可以共用）
+         * 跨页的值（不对齐步长时页尾的几个位置）不参与扫描
+         */
+        void Next(const Snapshot::PageSnapshot& current, const NextCondition<T>& condition, unsigned threads = 0) {
+            std::vector<PageState> next(states.size());
+            std::vector<uint8_t> keep(states.size(), 0);
+            size_t chunks = (states.size() + PagesPerChunk - 1) / PagesPerChunk;
+
+            PatternEngine::ChunkStealingPool::Run(chunks, threads, [&](size_t c) {
+                std::vector<uint8_t> oldPage(Snapshot::PageSize), newPage(Snapshot::PageSize);
+                size_t end = (c + 1) * PagesPerChunk < states.size() ? (c + 1) * PagesPerChunk : states.size();
+                for (size_t i = c * PagesPerChunk; i < end; i++) {
+                    keep[i] = Refine(states[i], current, condition, oldPage.data(), newPage.data(), next[i]);
+                }
+            });
+
+            std::vector<PageState> survivors;
+            for (size_t i = 0; i < next.size(); i++) {
+                if (keep[i]) survivors.push_back(std::move(next[i]));
+            }
+            states = std::move(survivors);
+        }
+
+        uint64_t Count() const {
+            uint64_t total = 0;
+            for (const PageState& state : states) total += state.count;
+            return total;
+        }
+
+        size_t PageCount() const { return states.size(); }
+
+        // 依次给出每个候选的地址和上次的值（逐页解压）
+        template<typename Fn>
+        void ForEach(Fn fn) const {
+            std::vector<uint8_t> buffer(Snapshot::PageSize);
+            for (const PageState& state : states) {
+                if (!state.page.Read(buffer.data())) continue;
+                for (size_t k = 0; k < positionsPerPage; k++) {
+                    if (state.all || Test(state.bits, k)) {
+                        fn(state.page.address + k * stride, LoadValue<T>(buffer.data() + k * stride));
+                    }
+                }
+            }
+        }
+
+        // 候选集合占用的内存（页数据可能与快照共用，这里全部算上）
+        size_t MemoryBytes() const {
+            size_t total = states.capacity() * sizeof(PageState);
+            for (const PageState& state : states) {
+                if (state.page.blob) total += state.page.blob->size();
+                total += state.bits.capacity() * sizeof(uint64_t);
+            }
+            return total;
+        }
+
+    private:
+        struct PageState {
+            Snapshot::SnapshotPage page;    // 上次扫描时这一页的内容
+            bool all = false;               // 整页都是候选（不需要位图）
+            uint32_t count = 0;
+            std::vector<uint64_t> bits;
+        };
+
+        static bool Test(const std::vector<uint64_t>& bits, size_t k) {
+            return (bits[k >> 6] >> (k & 63)) & 1;
+        }
+
+        bool Refine(const PageState& state, const Snapshot::PageSnapshot& current, const NextCondition<T>& condition,
+                    uint8_t* oldPage, uint8_t* newPage, PageState& out) const {
+            const Snapshot::SnapshotPage* page = current.Find(state.page.address);
+            if (!page) return false;  // 页已经释放
+
+            bool same = page->hash == state.page.hash;
+            if (same && condition.type != NextScanType::Value) {
+                // 内容没变：变动/增加/减少都不可能满足；未变动全部满足
+                if (condition.type != NextScanType::Unchanged) return false;
+                out = state;
+                out.page = *page;
+                return true;
+            }
+
+            if (!page->Read(newPage)) return false;
+            std::vector<uint64_t> bits((positionsPerPage + 63) / 64, 0);
+
+            if (condition.type == NextScanType::Value) {
+                // 与上次的值无关，直接对整页做 SIMD 扫描，再与原候选取交集
+                ScanOptions options;
+                options.stride = stride;
+                options.threads = 1;
+                HitBitmap hits = FirstScan(newPage, Snapshot::PageSize, condition.value, options);
+                bits = hits.Words();
+                if (!state.all) {
+                    for (size_t w = 0; w < bits.size(); w++) bits[w] &= state.bits[w];
+                }
+            }
+            else {
+                if (!state.page.Read(oldPage)) return false;
+                for (size_t k = 0; k < positionsPerPage; k++) {
+                    if (!state.all && !Test(state.bits, k)) continue;
+                    T previous = LoadValue<T>(oldPage + k * stride);
+                    T now = LoadValue<T>(newPage + k * stride);
+                    if (condition.Test(now, previous)) bits[k >> 6] |= 1ULL << (k & 63);
+                }
+            }
+
+            uint32_t count = 0;
+            for (uint64_t w : bits) count += HitBitmap::PopCount(w);
+            if (count == 0) return false;
+
+            out.page = *page;
+            out.count = count;
+            out.all = count == positionsPerPage;
+            if (!out.all) out.bits = std::move(bits);
+            return true;
+        }
+
+        size_t stride;
+        size_t positionsPerPage;
+        std::vector<PageState> states;   // 按地址升序
+    };
+}
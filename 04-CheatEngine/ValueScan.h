@@ -0,0 +1,483 @@
+/*
+ * ========================================
+ * 第四课补充：数值扫描引擎（CE 首次扫描）
+ * ========================================
+ *
+ * CE 的"首次扫描"就是：在一大片内存里找出所有等于/介于某个值的地址。
+ * 01-BasicMemory 的 Demo_SimpleSearch 用的是逐个 int 比较 + 逐个打印，
+ * 面对几 GB 的内存快照就太慢了。
+ *
+ * 本引擎：
+ * 1. 支持 int8/16/32/64、float、double
+ * 2. 比较方式：精确值、范围 [low, high]、浮点误差 |x - value| <= epsilon
+ * 3. 步长：对齐（步长 = sizeof(T)，CE 的"快速扫描"）或不对齐（步长 1、2...）
+ * 4. SSE2/AVX2 一次比较 16/32 字节，结果写成位图（每个候选地址 1 bit），不逐个打印
+ * 5. 大块内存按块多线程扫描
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include "../03-ReverseTools/ParallelScan.h"
+
+namespace ValueScan {
+
+    // ====================================
+    // 第一部分：扫描条件
+    // ====================================
+
+    enum class CompareMode {
+        Exact,      // x == value
+        Range,      // low <= x <= high
+        Epsilon     // |x - value| <= epsilon（整数会被换算成范围）
+    };
+
+    template<typename T>
+    struct Condition {
+        static_assert(std::is_arithmetic<T>::value, "ValueScan 只支持整数和浮点");
+
+        CompareMode mode = CompareMode::Exact;
+        T value = 0;
+        T low = 0;
+        T high = 0;
+        T epsilon = 0;
+
+        static Condition Exact(T v) {
+            Condition c;
+            c.mode = CompareMode::Exact;
+            c.value = v;
+            return c;
+        }
+
+        static Condition Between(T lo, T hi) {
+            Condition c;
+            c.mode = CompareMode::Range;
+            c.low = lo;
+            c.high = hi;
+            return c;
+        }
+
+        static Condition Near(T v, T eps) {
+            Condition c;
+            c.mode = CompareMode::Epsilon;
+            c.value = v;
+            c.epsilon = eps;
+            return c.Normalized();
+        }
+
+        // 整数没有"误差"，统一换算成范围（注意不要溢出）
+        Condition Normalized() const {
+            if (std::is_floating_point<T>::value || mode != CompareMode::Epsilon) return *this;
+            Condition c = *this;
+            c.mode = CompareMode::Range;
+            const T lowest = std::numeric_limits<T>::lowest();
+            const T highest = (std::numeric_limits<T>::max)();
+            c.low = value < lowest + epsilon ? lowest : (T)(value - epsilon);
+            c.high = value > highest - epsilon ? highest : (T)(value + epsilon);
+            return c;
+        }
+
+        bool Test(T x) const {
+            switch (mode) {
+                case CompareMode::Exact:   return x == value;
+                case CompareMode::Range:   return x >= low && x <= high;
+                case CompareMode::Epsilon: return (x > value ? x - value : value - x) <= epsilon;
+            }
+            return false;
+        }
+    };
+
+    template<typename T>
+    inline T LoadValue(const uint8_t* p) {
+        T v;
+        memcpy(&v, p, sizeof(T));
+        return v;
+    }
+
+    // ====================================
+    // 第二部分：命中位图
+    // ====================================
+
+    /*
+     * 第 k 个 bit 对应地址 base + k * stride
+     * 2GB 内存、步长 4 -> 5 亿个候选 -> 64MB 位图（直接存地址要 4GB）
+     */
+    class HitBitmap {
+    public:
+        HitBitmap() = default;
+        HitBitmap(size_t positionCount, size_t strideBytes)
+            : positions(positionCount), stride(strideBytes), words((positionCount + 63) / 64, 0) {}
+
+        size_t Positions() const { return positions; }
+        size_t Stride() const { return stride; }
+        const std::vector<uint64_t>& Words() const { return words; }
+        std::vector<uint64_t>& Words() { return words; }
+
+        void Set(size_t k) { words[k >> 6] |= 1ULL << (k & 63); }
+        bool Test(size_t k) const { return (words[k >> 6] >> (k & 63)) & 1; }
+
+        // 把 lanes 个连续 bit 一次写入（k 必须是 lanes 的倍数，lanes 整除 64）
+        void OrBits(size_t k, uint64_t bits) { words[k >> 6] |= bits << (k & 63); }
+
+        size_t Count() const {
+            size_t n = 0;
+            for (uint64_t w : words) n += PopCount(w);
+            return n;
+        }
+
+        // 依次给出每个命中的偏移（相对扫描起点）
+        template<typename Fn>
+        void ForEach(Fn fn) const {
+            for (size_t w = 0; w < words.size(); w++) {
+                uint64_t bits = words[w];
+                while (bits) {
+                    size_t k = w * 64 + CountTrailingZeros64(bits);
+                    fn(k * stride);
+                    bits &= bits - 1;
+                }
+            }
+        }
+
+        static unsigned PopCount(uint64_t w) {
+#if defined(_MSC_VER)
+            return (unsigned)__popcnt64(w);
+#else
+            return (unsigned)__builtin_popcountll(w);
+#endif
+        }
+
+        static unsigned CountTrailingZeros64(uint64_t w) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, w);
+            return (unsigned)index;
+#else
+            return (unsigned)__builtin_ctzll(w);
+#endif
+        }
+
+    private:
+        size_t positions = 0;
+        size_t stride = 1;
+        std::vector<uint64_t> words;
+    };
+
+    // ====================================
+    // 第三部分：SIMD 内核
+    // ====================================
+
+    /*
+     * 每种类型一个 Kernel：
+     * - Lanes：一次比较多少个值（0 表示没有 SIMD，走标量）
+     * - Match(p)：比较 p 开始的 Lanes 个连续值，返回每个值一个 bit 的掩码
+     */
+    template<typename T, typename Enable = void>
+    struct Kernel {
+        static constexpr size_t Lanes = 0;
+        explicit Kernel(const Condition<T>&) {}
+        uint32_t Match(const uint8_t*) const { return 0; }
+    };
+
+#if defined(PATTERN_SCAN_SSE2)
+
+    // 整数范围比较：low <= x <= high  <=>  !(low > x) && !(x > high)
+#define VALUESCAN_INT_KERNEL(Type, Bits, LaneCount, MoveMask)                                      \
+    template<>                                                                                     \
+    struct Kernel<Type> {                                                                          \
+        static constexpr size_t Lanes = LaneCount;                                                 \
+        CompareMode mode;                                                                          \
+        __m128i value, low, high;                                                                  \
+        explicit Kernel(const Condition<Type>& c)                                                  \
+            : mode(c.mode), value(_mm_set1_epi##Bits(c.value)),                                    \
+              low(_mm_set1_epi##Bits(c.low)), high(_mm_set1_epi##Bits(c.high)) {}                  \
+        uint32_t Match(const uint8_t* p) const {                                                   \
+            __m128i x = _mm_loadu_si128((const __m128i*)p);                                        \
+            if (mode == CompareMode::Exact) return MoveMask(_mm_cmpeq_epi##Bits(x, value));        \
+            __m128i outside = _mm_or_si128(_mm_cmpgt_epi##Bits(low, x), _mm_cmpgt_epi##Bits(x, high)); \
+            return ~MoveMask(outside) & ((1u << Lanes) - 1);                                       \
+        }                                                                                          \
+    };
+
+    inline uint32_t MoveMask8(__m128i m) { return (uint32_t)_mm_movemask_epi8(m); }
+    inline uint32_t MoveMask16(__m128i m) { return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(m, _mm_setzero_si128())) & 0xFF; }
+    inline uint32_t MoveMask32(__m128i m) { return (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(m)); }
+
+#if !defined(PATTERN_SCAN_AVX2)
+    VALUESCAN_INT_KERNEL(int8_t, 8, 16, MoveMask8)
+    VALUESCAN_INT_KERNEL(int32_t, 32, 4, MoveMask32)
+#endif
+    VALUESCAN_INT_KERNEL(int16_t, 16, 8, MoveMask16)
+#undef VALUESCAN_INT_KERNEL
+
+#if !defined(PATTERN_SCAN_AVX2)
+    // int64：SSE2 没有 64 位比较，精确值用两个 32 位相等拼出来；范围走标量
+    template<>
+    struct Kernel<int64_t> {
+        static constexpr size_t Lanes = 2;
+        CompareMode mode;
+        __m128i value;
+        Condition<int64_t> scalar;
+        explicit Kernel(const Condition<int64_t>& c) : mode(c.mode), value(_mm_set1_epi64x(c.value)), scalar(c) {}
+        uint32_t Match(const uint8_t* p) const {
+            if (mode != CompareMode::Exact) {
+                return (uint32_t)scalar.Test(LoadValue<int64_t>(p)) | ((uint32_t)scalar.Test(LoadValue<int64_t>(p + 8)) << 1);
+            }
+            __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)p), value);
+            eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+            return (uint32_t)_mm_movemask_pd(_mm_castsi128_pd(eq));
+        }
+    };
+
+    template<>
+    struct Kernel<float> {
+        static constexpr size_t Lanes = 4;
+        CompareMode mode;
+        __m128 value, low, high, epsilon, absMask;
+        explicit Kernel(const Condition<float>& c)
+            : mode(c.mode), value(_mm_set1_ps(c.value)), low(_mm_set1_ps(c.low)), high(_mm_set1_ps(c.high)),
+              epsilon(_mm_set1_ps(c.epsilon)), absMask(_mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF))) {}
+        uint32_t Match(const uint8_t* p) const {
+            __m128 x = _mm_loadu_ps((const float*)p);
+            switch (mode) {
+                case CompareMode::Exact:
+                    return (uint32_t)_mm_movemask_ps(_mm_cmpeq_ps(x, value));
+                case CompareMode::Range:
+                    return (uint32_t)_mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(x, low), _mm_cmple_ps(x, high)));
+                default:
+                    return (uint32_t)_mm_movemask_ps(_mm_cmple_ps(_mm_and_ps(_mm_sub_ps(x, value), absMask), epsilon));
+            }
+        }
+    };
+
+    template<>
+    struct Kernel<double> {
+        static constexpr size_t Lanes = 2;
+        CompareMode mode;
+        __m128d value, low, high, epsilon, absMask;
+        explicit Kernel(const Condition<double>& c)
+            : mode(c.mode), value(_mm_set1_pd(c.value)), low(_mm_set1_pd(c.low)), high(_mm_set1_pd(c.high)),
+              epsilon(_mm_set1_pd(c.epsilon)), absMask(_mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL))) {}
+        uint32_t Match(const uint8_t* p) const {
+            __m128d x = _mm_loadu_pd((const double*)p);
+            switch (mode) {
+                case CompareMode::Exact:
+                    return (uint32_t)_mm_movemask_pd(_mm_cmpeq_pd(x, value));
+                case CompareMode::Range:
+                    return (uint32_t)_mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(x, low), _mm_cmple_pd(x, high)));
+                default:
+                    return (uint32_t)_mm_movemask_pd(_mm_cmple_pd(_mm_and_pd(_mm_sub_pd(x, value), absMask), epsilon));
+            }
+        }
+    };
+#endif  // !PATTERN_SCAN_AVX2
+
+#if defined(PATTERN_SCAN_AVX2)
+    // AVX2：一次 32 字节（int16 仍使用上面的 SSE2 版本）
+    template<>
+    struct Kernel<int8_t> {
+        static constexpr size_t Lanes = 32;
+        CompareMode mode;
+        __m256i value, low, high;
+        explicit Kernel(const Condition<int8_t>& c)
+            : mode(c.mode), value(_mm256_set1_epi8(c.value)), low(_mm256_set1_epi8(c.low)), high(_mm256_set1_epi8(c.high)) {}
+        uint32_t Match(const uint8_t* p) const {
+            __m256i x = _mm256_loadu_si256((const __m256i*)p);
+            if (mode == CompareMode::Exact) return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, value));
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi8(low, x), _mm256_cmpgt_epi8(x, high));
+            return ~(uint32_t)_mm256_movemask_epi8(outside);
+        }
+    };
+
+    template<>
+    struct Kernel<int32_t> {
+        static constexpr size_t Lanes = 8;
+        CompareMode mode;
+        __m256i value, low, high;
+        explicit Kernel(const Condition<int32_t>& c)
+            : mode(c.mode), value(_mm256_set1_epi32(c.value)), low(_mm256_set1_epi32(c.low)), high(_mm256_set1_epi32(c.high)) {}
+        uint32_t Match(const uint8_t* p) const {
+            __m256i x = _mm256_loadu_si256((const __m256i*)p);
+            if (mode == CompareMode::Exact) {
+                return (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, value)));
+            }
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low, x), _mm256_cmpgt_epi32(x, high));
+            return ~(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF;
+        }
+    };
+
+    template<>
+    struct Kernel<int64_t> {
+        static constexpr size_t Lanes = 4;
+        CompareMode mode;
+        __m256i value, low, high;
+        explicit Kernel(const Condition<int64_t>& c)
+            : mode(c.mode), value(_mm256_set1_epi64x(c.value)), low(_mm256_set1_epi64x(c.low)), high(_mm256_set1_epi64x(c.high)) {}
+        uint32_t Match(const uint8_t* p) const {
+            __m256i x = _mm256_loadu_si256((const __m256i*)p);
+            if (mode == CompareMode::Exact) {
+                return (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, value)));
+            }
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi64(low, x), _mm256_cmpgt_epi64(x, high));
+            return ~(uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(outside)) & 0xF;
+        }
+    };
+
+    template<>
+    struct Kernel<float> {
+        static constexpr size_t Lanes = 8;
+        CompareMode mode;
+        __m256 value, low, high, epsilon, absMask;
+        explicit Kernel(const Condition<float>& c)
+            : mode(c.mode), value(_mm256_set1_ps(c.value)), low(_mm256_set1_ps(c.low)), high(_mm256_set1_ps(c.high)),
+              epsilon(_mm256_set1_ps(c.epsilon)), absMask(_mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF))) {}
+        uint32_t Match(const uint8_t* p) const {
+            __m256 x = _mm256_loadu_ps((const float*)p);
+            switch (mode) {
+                case CompareMode::Exact:
+                    return (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(x, value, _CMP_EQ_OQ));
+                case CompareMode::Range:
+                    return (uint32_t)_mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(x, low, _CMP_GE_OQ),
+                                                                      _mm256_cmp_ps(x, high, _CMP_LE_OQ)));
+                default:
+                    return (uint32_t)_mm256_movemask_ps(
+                        _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(x, value), absMask), epsilon, _CMP_LE_OQ));
+            }
+        }
+    };
+
+    template<>
+    struct Kernel<double> {
+        static constexpr size_t Lanes = 4;
+        CompareMode mode;
+        __m256d value, low, high, epsilon, absMask;
+        explicit Kernel(const Condition<double>& c)
+            : mode(c.mode), value(_mm256_set1_pd(c.value)), low(_mm256_set1_pd(c.low)), high(_mm256_set1_pd(c.high)),
+              epsilon(_mm256_set1_pd(c.epsilon)), absMask(_mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL))) {}
+        uint32_t Match(const uint8_t* p) const {
+            __m256d x = _mm256_loadu_pd((const double*)p);
+            switch (mode) {
+                case CompareMode::Exact:
+                    return (uint32_t)_mm256_movemask_pd(_mm256_cmp_pd(x, value, _CMP_EQ_OQ));
+                case CompareMode::Range:
+                    return (uint32_t)_mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(x, low, _CMP_GE_OQ),
+                                                                      _mm256_cmp_pd(x, high, _CMP_LE_OQ)));
+                default:
+                    return (uint32_t)_mm256_movemask_pd(
+                        _mm256_cmp_pd(_mm256_and_pd(_mm256_sub_pd(x, value), absMask), epsilon, _CMP_LE_OQ));
+            }
+        }
+    };
+#endif  // PATTERN_SCAN_AVX2
+
+#endif  // PATTERN_SCAN_SSE2
+
+    // 无符号类型按同宽度有符号处理（精确比较结果相同；范围比较请使用有符号类型）
+    template<typename T, bool Integral = std::is_integral<T>::value>
+    struct KernelTypeOf { using type = T; };
+
+    template<typename T>
+    struct KernelTypeOf<T, true> { using type = typename std::make_signed<T>::type; };
+
+    template<typename T>
+    using KernelType = typename KernelTypeOf<T>::type;
+
+    // ====================================
+    // 第四部分：扫描驱动
+    // ====================================
+
+    // 候选位置数：最后一个值必须完整落在 [0, size) 内
+    inline size_t PositionCount(size_t size, size_t valueSize, size_t stride) {
+        return size < valueSize ? 0 : (size - valueSize) / stride + 1;
+    }
+
+    /*
+     * 扫描候选位置 [kBegin, kEnd)，写入 bitmap
+     * kBegin 必须是 64 * phases 的倍数，保证不同线程写不同的位图字
+     */
+    template<typename T>
+    inline void ScanPositions(const uint8_t* data, const Condition<T>& cond, size_t stride,
+                              size_t kBegin, size_t kEnd, HitBitmap& bitmap) {
+        using K = KernelType<T>;
+        const size_t width = sizeof(T);
+        const size_t lanes = Kernel<K>::Lanes;
+        size_t k = kBegin;
+
+        // 有符号比较内核处理不了无符号的范围，这种情况走标量
+        if (lanes > 0 && (std::is_signed<T>::value || cond.mode == CompareMode::Exact)) {
+            Condition<K> kc;
+            kc.mode = cond.mode;
+            kc.value = (K)cond.value;
+            kc.low = (K)cond.low;
+            kc.high = (K)cond.high;
+            kc.epsilon = (K)cond.epsilon;
+            const Kernel<K> kernel(kc);
+
+            if (stride == width) {
+                // 对齐步长：连续 Lanes 个值正好对应位图里连续 Lanes 个 bit
+                for (; k + lanes <= kEnd; k += lanes) {
+                    bitmap.OrBits(k, kernel.Match(data + k * width));
+                }
+            }
+            else if (stride < width && width % stride == 0) {
+                // 不对齐步长：拆成 width / stride 个"相位"，
+                // 相位 j 的第 m 个值位于 m * width + j * stride，内部又是对齐扫描
+                const size_t phases = width / stride;
+                size_t m = kBegin / phases;
+                for (; (m + lanes) * phases <= kEnd; m += lanes) {
+                    for (size_t j = 0; j < phases; j++) {
+                        uint32_t bits = kernel.Match(data + m * width + j * stride);
+                        while (bits) {
+                            bitmap.Set((m + PatternEngine::CountTrailingZeros(bits)) * phases + j);
+                            bits &= bits - 1;
+                        }
+                    }
+                }
+                k = m * phases;
+            }
+        }
+
+        // 标量收尾（以及没有 SIMD 内核的情况）
+        for (; k < kEnd; k++) {
+            if (cond.Test(LoadValue<T>(data + k * stride))) bitmap.Set(k);
+        }
+    }
+
+    struct ScanOptions {
+        size_t stride = 0;                  // 0 = sizeof(T)（对齐扫描）
+        size_t chunkPositions = 1 << 20;    // 每个任务的候选位置数
+        unsigned threads = 0;               // 0 = 全部硬件线程
+    };
+
+    /*
+     * 首次扫描：返回命中位图
+     * 用法：
+     *   auto hits = ValueScan::FirstScan(data, size, ValueScan::Condition<int32_t>::Exact(100));
+     *   hits.ForEach([&](size_t offset) { ... data + offset ... });
+     */
+    template<typename T>
+    inline HitBitmap FirstScan(const uint8_t* data, size_t size, const Condition<T>& condition,
+                               const ScanOptions& options = ScanOptions()) {
+        const Condition<T> cond = condition.Normalized();
+        const size_t stride = options.stride ? options.stride : sizeof(T);
+        const size_t positions = PositionCount(size, sizeof(T), stride);
+        HitBitmap bitmap(positions, stride);
+        if (positions == 0) return bitmap;
+
+        // 任务边界对齐到 64 * phases，保证每个位图字只属于一个任务
+        const size_t phases = (stride < sizeof(T) && sizeof(T) % stride == 0) ? sizeof(T) / stride : 1;
+        const size_t unit = 64 * phases;
+        size_t chunk = options.chunkPositions < unit ? unit : options.chunkPositions / unit * unit;
+        const size_t chunks = (positions + chunk - 1) / chunk;
+
+        PatternEngine::ChunkStealingPool::Run(chunks, options.threads, [&](size_t i) {
+            size_t kBegin = i * chunk;
+            size_t kEnd = kBegin + chunk < positions ? kBegin + chunk : positions;
+            ScanPositions(data, cond, stride, kBegin, kEnd, bitmap);
+        });
+        return bitmap;
+    }
+}
@@ -8,6 +8,9 @@
  */
 
 #include "SimulatedGame.h"
+#include "../03-ReverseTools/PointerChain.h"
+#include "../03-ReverseTools/ArrayReader.h"
+#include "../03-ReverseTools/OffsetDatabase.h"
 #include <iostream>
 #include <iomanip>
 
@@ -16,6 +19,37 @@ using namespace std;
 // 全局引擎实例定义
 UGameEngine* GEngine = nullptr;
 
+// ====================================
+// 偏移（SimulatedGame.h 按这些默认值布局）
+// ====================================
+
+// 模拟类带虚函数，不是标准布局，不能用 offsetof；和真实项目一样用 dump 出来的偏移
+namespace Offsets {
+    uint32_t GameEngine_GameViewport = 0x78;
+    uint32_t GameViewportClient_World = 0x80;
+    uint32_t World_GameState = 0x150;
+    uint32_t PlayerState_PlayerName = 0x2A0;
+    uint32_t PlayerState_PlayerId = 0x2C0;
+    uint32_t PlayerState_TeamId = 0x2C4;
+
+    // 启动时调用一次（在第一次读内存之前）：有 offsets.db 时按当前游戏版本覆盖默认值，
+    // 游戏更新后换数据库文件，不用改代码重新编译
+    void Bind(const char* path = "offsets.db") {
+        OffsetDatabase offsets;
+        if (!offsets.Open(path)) return;
+        offsets.SelectBuild(OffsetDatabase::HashBuild((const uint8_t*)GetModuleHandleW(nullptr), 4096));
+        size_t missing = offsets.Bind({
+            { "UGameEngine", "GameViewport", &GameEngine_GameViewport },
+            { "UGameViewportClient", "World", &GameViewportClient_World },
+            { "UWorld", "GameState", &World_GameState },
+            { "APlayerState", "PlayerName", &PlayerState_PlayerName },
+            { "APlayerState", "PlayerId", &PlayerState_PlayerId },
+            { "APlayerState", "TeamId", &PlayerState_TeamId },
+        });
+        cout << "偏移数据库：" << offsets.Count() << " 条，" << missing << " 个使用默认值" << endl;
+    }
+}
+
 // ====================================
 // ESP 数据结构
 // ====================================
@@ -43,26 +77,28 @@ public:
         return GEngine;
     }
     
+    // 每帧开始时调用：之前读到的指针按寿命过期
+    static void BeginFrame() {
+        Chains().BeginFrame();
+    }
+    
     // 读取World
     static UWorld* GetWorld() {
-        auto engine = GetGEngine();
-        if (!engine) return nullptr;
-        
-        // 偏移: +0x78
-        auto viewport = engine->GameViewport;
-        if (!viewport) return nullptr;
-        
-        // 偏移: +0x80
-        return viewport->World;
+        // GEngine -> GameViewport(+0x78) -> World(+0x80)，前缀和 GetGameState 共用
+        uintptr_t world;
+        return Chains().ReadPointer(Ids().world, world) ? (UWorld*)world : nullptr;
     }
     
     // 读取GameState
     static AGameState* GetGameState() {
-        auto world = GetWorld();
-        if (!world) return nullptr;
-        
-        // 偏移: +0x150
-        return world->GameState;
+        // 偏移: +0x150（World 之前的部分命中缓存，不再重读）
+        uintptr_t gameState;
+        return Chains().ReadPointer(Ids().gameState, gameState) ? (AGameState*)gameState : nullptr;
+    }
+    
+    // 本帧的读取统计（实际读取次数 / 缓存命中次数）
+    static const PointerChainResolver::Stats& GetStats() {
+        return Chains().GetStats();
     }
     
     // 读取所有角色
@@ -83,6 +119,42 @@ public:
         // 假设第一个是本地玩家
         return (ACharacter*)actors[0];
     }
+    
+private:
+    struct ChainIds {
+        PointerChainResolver::ChainId engine;
+        PointerChainResolver::ChainId gameViewport;
+        PointerChainResolver::ChainId world;
+        PointerChainResolver::ChainId gameState;
+    };
+    
+    // 同进程读取：这里直接拷贝；外部进程换成 ReadProcessMemory 即可
+    static PointerChainResolver& Chains() {
+        static PointerChainResolver resolver([](uintptr_t address, void* dest, size_t size) {
+            if (!address) return false;
+            memcpy(dest, (const void*)address, size);
+            return true;
+        });
+        return resolver;
+    }
+    
+    // 链只声明一次；偏移用 Offsets 里绑定好的值（真实项目中来自 SDK dump / offsets.db）
+    static const ChainIds& Ids() {
+        static const ChainIds ids = [] {
+            PointerChainResolver& chains = Chains();
+            ChainIds result;
+            result.engine = chains.Root((uintptr_t)&GEngine);
+            result.gameViewport = chains.Extend(result.engine, { Offsets::GameEngine_GameViewport });
+            result.world = chains.Extend(result.gameViewport, { Offsets::GameViewportClient_World });
+            result.gameState = chains.Extend(result.world, { Offsets::World_GameState });
+            
+            // 只有 GEngine 本身整局不变，30 帧才重新确认一次；
+            // 它下面的指针换地图时就会变，保持默认寿命（每帧重读）
+            chains.SetLifetime(result.engine, 30);
+            return result;
+        }();
+        return ids;
+    }
 };
 
 // ====================================
@@ -269,9 +341,30 @@ void DemonstrateOffsetFinding() {
     cout << "     -> World [+0x80]" << endl;
     cout << "        -> GameState [+0x150]" << endl;
     cout << "           -> PlayerArray [+0x2A8]" << endl;
-    cout << "        -> Levels [+0x148]" << endl;
+    cout << "        -> Levels [+0x140]" << endl;
     cout << "           -> Actors" << endl;
     
+    // 批量按列读取 PlayerArray：头、指针块各一次，字段合并成整页读取
+    if (AGameState* gameState = MemoryReader::GetGameState()) {
+        // 读自己也走 ReadProcessMemory：按整页读取会越过对象边界，直接 memcpy 不安全
+        ArrayReader reader = ArrayReader::ForProcess();
+        size_t colId = reader.AddField<int32_t>(Offsets::PlayerState_PlayerId);
+        size_t colTeam = reader.AddField<int32_t>(Offsets::PlayerState_TeamId);
+        size_t colName = reader.AddField(Offsets::PlayerState_PlayerName, sizeof(APlayerState::PlayerName));
+        
+        ArrayColumns players;
+        if (reader.Read((uintptr_t)&gameState->PlayerArray, players)) {
+            cout << "\n【批量读取 PlayerArray】" << players.Rows() << " 个玩家, "
+                 << reader.GetStats().calls << " 次读取" << endl;
+            const int32_t* ids = players.Column<int32_t>(colId);
+            const int32_t* teams = players.Column<int32_t>(colTeam);
+            for (size_t i = 0; i < players.Rows(); i++) {
+                if (!players.Valid(i)) continue;
+                cout << "  [" << ids[i] << "] Team " << teams[i] << "  " << players.Text(colName, i) << endl;
+            }
+        }
+    }
+    
     cout << "\n【如何在真实游戏中找到这些偏移】" << endl;
     cout << "1. 用CE找到玩家对象地址" << endl;
     cout << "2. 用 'Find out what accesses this address' 找到访问代码" << endl;
@@ -292,6 +385,9 @@ int main() {
     cout << "║    实战项目：ESP功能完整实现              ║" << endl;
     cout << "╚═══════════════════════════════════════════╝" << endl;
     
+    // 偏移：默认值 + offsets.db
+    Offsets::Bind();
+    
     // 初始化游戏引擎
     GEngine = new UGameEngine();
     
@@ -321,6 +417,9 @@ int main() {
             cout << "║    ESP演示 - Tick: " << setw(5) << tick << "                ║" << endl;
             cout << "╚═══════════════════════════════════════════╝" << endl;
             
+            // 新的一帧：指针链缓存按帧号过期
+            MemoryReader::BeginFrame();
+            
             // 更新ESP
             esp.Update();
             
@@ -336,6 +435,9 @@ int main() {
             // 显示游戏状态
             game.PrintGameState();
             
+            auto& stats = MemoryReader::GetStats();
+            cout << "指针链: 实际读取 " << stats.reads << " 次, 命中缓存 " << stats.hits << " 次" << endl;
+            
             cout << "\n按 Ctrl+C 退出" << endl;
         }
         
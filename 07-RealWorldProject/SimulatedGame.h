@@ -127,11 +127,13 @@ public:
 
 class APlayerState : public AActor {
 public:
+    uint8_t Padding9[0x2A0 - sizeof(AActor)];
     char PlayerName[32];            // +0x2A0
     int32_t PlayerId;               // +0x2C0
     int32_t TeamId;                 // +0x2C4
     
     APlayerState() : PlayerId(0), TeamId(0) {
+        memset(Padding9, 0, sizeof(Padding9));
         memset(PlayerName, 0, sizeof(PlayerName));
     }
 };
@@ -210,9 +212,9 @@ public:
 
 class UWorld : public UObject {
 public:
-    TArray<ULevel*> Levels;            // +0x148
+    uint8_t Padding6[0x140 - sizeof(UObject)];
+    TArray<ULevel*> Levels;            // +0x140
     AGameState* GameState;             // +0x150
-    uint8_t Padding6[0x148 - sizeof(UObject)];
     
     UWorld() : GameState(nullptr) {
         memset(Padding6, 0, sizeof(Padding6));
@@ -234,8 +236,8 @@ public:
 
 class UGameViewportClient : public UObject {
 public:
-    UWorld* World;                     // +0x80
     uint8_t Padding7[0x80 - sizeof(UObject)];
+    UWorld* World;                     // +0x80
     
     UGameViewportClient() : World(nullptr) {
         memset(Padding7, 0, sizeof(Padding7));
@@ -249,8 +251,8 @@ public:
 
 class UGameEngine : public UObject {
 public:
-    UGameViewportClient* GameViewport; // +0x78
     uint8_t Padding8[0x78 - sizeof(UObject)];
+    UGameViewportClient* GameViewport; // +0x78
     
     UGameEngine() : GameViewport(nullptr) {
         memset(Padding8, 0, sizeof(Padding8));